@@ -1,98 +1,492 @@
 #include "AsyncClient.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
 
-AsyncClient::AsyncClient(boost::asio::io_context& ioc, const string& ip, int port)
-    : _socket(ioc), _endpoint(make_address(ip), port) {
+AsyncClient::AsyncClient(boost::asio::io_context& ioc, const string& ip, int port, uint32_t max_frame_size,
+    const SocketOptions& socket_options)
+    : _socket(ioc), _endpoint(make_address(ip), port), _socket_options(socket_options), _reconnect_timer(ioc),
+    _max_frame_size(max_frame_size), _request_timer(ioc) {
     do_connect();
 }
 
 void AsyncClient::Close() {
     boost::asio::post(_socket.get_executor(), [this]() {
-        _socket.close();
+        if (_state == State::CLOSED) {
+            return;
+        }
+        ++_generation;
+        _state = State::CLOSED;
+        _connected.store(false, std::memory_order_relaxed);
+        boost::system::error_code ignored;
+        _socket.close(ignored);
+        _reconnect_timer.cancel();
+        FailPendingRequests(boost::asio::error::operation_aborted);
     });
 }
 
-void AsyncClient::Send(const string& msg) {
-    boost::asio::post(_socket.get_executor(), [this, msg]() {
-        bool write_in_progress = !_send_queue.empty();
-        
-        size_t request_length = msg.length();
-        if (request_length > MAX_LENGTH - HEAD_LENGTH) {
-            cout << "Message too long" << endl;
-            return;
+void AsyncClient::SetReconnect(bool enable, std::chrono::milliseconds min_delay, std::chrono::milliseconds max_delay) {
+    _reconnect = enable;
+    _reconnect_min_delay = std::max(min_delay, std::chrono::milliseconds(1));
+    _reconnect_max_delay = std::max(max_delay, _reconnect_min_delay);
+}
+
+void AsyncClient::SetMessageHandler(MessageHandler handler) {
+    _message_handler = std::move(handler);
+}
+
+void AsyncClient::SetConnectHandler(ConnectHandler handler) {
+    _connect_handler = std::move(handler);
+}
+
+void AsyncClient::SetBackpressureHandler(BackpressureHandler handler) {
+    _backpressure_handler = std::move(handler);
+}
+
+void AsyncClient::SetSendQueueLimits(size_t high_water, size_t low_water, size_t limit) {
+    _send_high_water = high_water;
+    _send_low_water = low_water;
+    _send_queue_limit = limit;
+}
+
+void AsyncClient::SetCompression(bool enable, uint32_t threshold) {
+    _compression = enable;
+    _compress_threshold = threshold;
+}
+
+bool AsyncClient::Send(const string& msg, short msg_id) {
+    return Send(msg.data(), msg.length(), msg_id);
+}
+
+bool AsyncClient::Send(const char* data, size_t length, short msg_id) {
+    vector<char> frame;
+    if (PrepareFrame(data, length, msg_id, 0, frame)) {
+        return false;
+    }
+    boost::asio::post(_socket.get_executor(), [this, frame = std::move(frame)]() mutable {
+        QueueFrame(std::move(frame));
+    });
+    return true;
+}
+
+boost::system::error_code AsyncClient::PrepareFrame(const char* data, size_t length, short msg_id, uint32_t request_id,
+    vector<char>& frame) {
+    size_t prefix = request_id != 0 ? MSG_REQUEST_ID_LENGTH : 0;
+    if (length + prefix > _max_frame_size) {
+        LOG_WARN("Message too long: ", length, ", max frame size: ", _max_frame_size);
+        return boost::asio::error::message_size;
+    }
+    // 协商了压缩算法时，不小于阈值的消息在调用线程上压缩；压缩后没有变小则按原样发送
+    thread_local vector<char> compressed;
+    uint8_t flags = request_id != 0 ? MSG_FLAG_REQUEST : MSG_FLAG_NONE;
+    uint8_t codec = _codec.load(std::memory_order_relaxed);
+    if (codec != 0 && length >= _compress_threshold && Compression::Compress(codec, data, length, compressed)) {
+        data = compressed.data();
+        length = compressed.size();
+        flags |= codec;
+    }
+    // 服务器读得比我们发得慢，队列超过硬上限时丢弃，避免无限占用内存
+    size_t bytes = length + prefix + MSG_HEAD_LENGTH;
+    if (_queued_bytes.load(std::memory_order_relaxed) + bytes > _send_queue_limit) {
+        _dropped_messages.fetch_add(1, std::memory_order_relaxed);
+        return boost::asio::error::no_buffer_space;
+    }
+    _queued_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    // 在调用线程上完成封包，IO 线程只负责入队；请求ID在消息体开头，不参与压缩
+    frame.resize(bytes);
+    MsgHeader head;
+    head.flags = flags;
+    head.msg_id = static_cast<uint16_t>(msg_id);
+    head.length = static_cast<uint32_t>(length + prefix);
+
+    EncodeMsgHeader(frame.data(), head);
+    if (request_id != 0) {
+        EncodeRequestId(frame.data() + MSG_HEAD_LENGTH, request_id);
+    }
+    memcpy(frame.data() + MSG_HEAD_LENGTH + prefix, data, length);
+    return boost::system::error_code();
+}
+
+void AsyncClient::QueueFrame(vector<char> frame) {
+    _send_queue.push_back(std::move(frame));
+
+    if (!_backpressure && _queued_bytes.load(std::memory_order_relaxed) > _send_high_water) {
+        _backpressure = true;
+        if (_backpressure_handler) {
+            _backpressure_handler(true);
         }
+    }
+    // 未连接时只排队，连接（或重连）成功后统一发送
+    if (_state == State::CONNECTED && !_writing) {
+        do_write();
+    }
+}
 
-        vector<char> send_data(request_length + HEAD_LENGTH);
-        short len_short = static_cast<short>(request_length);
-        
-        memcpy(send_data.data(), &len_short, HEAD_LENGTH);
-        memcpy(send_data.data() + HEAD_LENGTH, msg.c_str(), request_length);
+uint32_t AsyncClient::NextRequestId() {
+    uint32_t request_id = _next_request_id.fetch_add(1, std::memory_order_relaxed);
+    if (request_id == 0) {
+        request_id = _next_request_id.fetch_add(1, std::memory_order_relaxed);
+    }
+    return request_id;
+}
 
-        _send_queue.push(send_data);
+void AsyncClient::StartRequest(uint32_t request_id, boost::system::error_code ec, vector<char> frame,
+    std::chrono::steady_clock::time_point deadline, unique_ptr<RequestCompletion> completion) {
+    // 登记和发送都在 IO 线程上进行：先登记再入队，回复不可能早于登记到达
+    boost::asio::post(_socket.get_executor(),
+        [this, ec, request_id, deadline, frame = std::move(frame), completion = std::move(completion)]() mutable {
+            if (ec) {
+                completion->Complete(ec, RpcReply());
+                return;
+            }
+            _pending.emplace(request_id, std::move(completion));
+            _deadlines.emplace(deadline, request_id);
+            ArmRequestTimer(deadline);
+            QueueFrame(std::move(frame));
+        });
+}
+
+void AsyncClient::CompleteRequest(uint32_t request_id, short msg_id, const char* data, size_t length) {
+    auto iter = _pending.find(request_id);
+    if (iter == _pending.end()) {
+        LOG_DEBUG("Reply for unknown or timed out request ", request_id);
+        return;
+    }
+    auto completion = std::move(iter->second);
+    _pending.erase(iter);
+    // 回复大多按发送顺序到达，顺带弹出堆顶已完成的项，堆的大小与在途请求数相当
+    while (!_deadlines.empty() && _pending.find(_deadlines.top().second) == _pending.end()) {
+        _deadlines.pop();
+    }
+    RpcReply reply;
+    reply.msg_id = msg_id;
+    reply.data.assign(data, data + length);
+    completion->Complete(boost::system::error_code(), std::move(reply));
+}
+
+void AsyncClient::ArmRequestTimer(std::chrono::steady_clock::time_point deadline) {
+    if (deadline >= _request_timer_expiry) {
+        return;
+    }
+    // 重新设置会取消之前的等待，被取消的回调以 operation_aborted 返回
+    _request_timer_expiry = deadline;
+    _request_timer.expires_at(deadline);
+    _request_timer.async_wait([this](const boost::system::error_code& ec) {
+        HandleRequestTimer(ec);
+    });
+}
 
-        if (!write_in_progress) {
-            do_write();
+void AsyncClient::HandleRequestTimer(const boost::system::error_code& ec) {
+    if (ec == boost::asio::error::operation_aborted) {
+        return;
+    }
+    _request_timer_expiry = std::chrono::steady_clock::time_point::max();
+    auto now = std::chrono::steady_clock::now();
+    while (!_deadlines.empty() && _deadlines.top().first <= now) {
+        uint32_t request_id = _deadlines.top().second;
+        _deadlines.pop();
+        auto iter = _pending.find(request_id);
+        if (iter != _pending.end()) {
+            auto completion = std::move(iter->second);
+            _pending.erase(iter);
+            completion->Complete(boost::asio::error::timed_out, RpcReply());
         }
+    }
+    if (!_deadlines.empty()) {
+        ArmRequestTimer(_deadlines.top().first);
+    }
+}
+
+void AsyncClient::FailPendingRequests(const boost::system::error_code& ec) {
+    if (_pending.empty()) {
+        return;
+    }
+    // 先换出再逐个完成，完成回调里发起的新请求不受影响
+    auto pending = std::move(_pending);
+    _pending.clear();
+    _deadlines = decltype(_deadlines)();
+    _request_timer.cancel();
+    _request_timer_expiry = std::chrono::steady_clock::time_point::max();
+    for (auto& item : pending) {
+        item.second->Complete(ec, RpcReply());
+    }
+}
+
+void AsyncClient::FailSentRequests(const boost::system::error_code& ec) {
+    if (_pending.empty()) {
+        return;
+    }
+    // 发送队列中的请求帧没有完整写出（队首可能写了一部分，重连后整帧重发），服务器不可能处理过，继续等待
+    vector<uint32_t> unsent;
+    for (const auto& frame : _send_queue) {
+        if (static_cast<uint8_t>(frame[1]) & MSG_FLAG_REQUEST) {
+            unsent.push_back(DecodeRequestId(frame.data() + MSG_HEAD_LENGTH));
+        }
+    }
+    std::sort(unsent.begin(), unsent.end());
+    vector<unique_ptr<RequestCompletion>> failed;
+    for (auto iter = _pending.begin(); iter != _pending.end();) {
+        if (std::binary_search(unsent.begin(), unsent.end(), iter->first)) {
+            ++iter;
+        } else {
+            failed.push_back(std::move(iter->second));
+            iter = _pending.erase(iter);
+        }
+    }
+    for (auto& completion : failed) {
+        completion->Complete(ec, RpcReply());
+    }
+}
+
+void AsyncClient::FailRequest(uint32_t request_id, const boost::system::error_code& ec) {
+    auto iter = _pending.find(request_id);
+    if (iter == _pending.end()) {
+        return;
+    }
+    auto completion = std::move(iter->second);
+    _pending.erase(iter);
+    completion->Complete(ec, RpcReply());
+}
+
+void AsyncClient::HandleDisconnect(const boost::system::error_code& ec) {
+    if (_state == State::WAITING_RECONNECT || _state == State::CLOSED) {
+        return;
+    }
+    ++_generation;
+    _connected.store(false, std::memory_order_relaxed);
+    boost::system::error_code ignored;
+    _socket.close(ignored);
+    // 在途的 async_write 仍会回调（通常以 operation_aborted 返回，也可能已经写完），_writing 由它清除，
+    // 在此之前新连接不会开始写，队首帧不会被两个写操作同时引用
+    _disconnect_error = ec;
+    // 新连接要重新协商，协商完成之前不压缩
+    _codec.store(0, std::memory_order_relaxed);
+    if (!_reconnect) {
+        _state = State::CLOSED;
+        FailPendingRequests(ec);
+        return;
+    }
+    FailSentRequests(ec);
+    ScheduleReconnect();
+}
+
+void AsyncClient::ScheduleReconnect() {
+    _state = State::WAITING_RECONNECT;
+    // 指数退避：min_delay * 2^n，不超过 max_delay；实际等待在 [delay/2, delay] 内随机，
+    // 服务器重启时大量客户端不会在同一时刻重连
+    std::chrono::milliseconds delay = _reconnect_min_delay * (1LL << std::min(_reconnect_attempts, 20u));
+    delay = std::min(delay, _reconnect_max_delay);
+    ++_reconnect_attempts;
+    thread_local std::minstd_rand rng(std::random_device{}());
+    std::uniform_int_distribution<long long> jitter(0, delay.count() / 2);
+    auto wait = delay - std::chrono::milliseconds(jitter(rng));
+    LOG_INFO("Reconnecting to ", _endpoint.address().to_string(), ":", _endpoint.port(), " in ", wait.count(),
+        " ms (attempt ", _reconnect_attempts, ")");
+    _reconnect_timer.expires_after(wait);
+    _reconnect_timer.async_wait([this, generation = _generation](const boost::system::error_code& ec) {
+        if (ec || generation != _generation) {
+            return;
+        }
+        do_connect();
     });
 }
 
 void AsyncClient::do_connect() {
+    // 先打开套接字设置选项，缓冲区大小要在握手之前确定；打开失败时由 async_connect 报告错误
+    _state = State::CONNECTING;
+    boost::system::error_code ec;
+    _socket.open(_endpoint.protocol(), ec);
+    if (!ec) {
+        _socket_options.ApplyTo(_socket);
+    }
     _socket.async_connect(_endpoint,
-        [this](boost::system::error_code ec) {
+        [this, generation = _generation](boost::system::error_code ec) {
+            if (generation != _generation) {
+                return;
+            }
             if (!ec) {
-                cout << "Connected to server successfully." << endl;
+                LOG_INFO("Connected to server successfully.");
+                _state = State::CONNECTED;
+                _connected.store(true, std::memory_order_relaxed);
+                _reconnect_attempts = 0;
+                // 声明支持的压缩算法；服务器回复之前发送的帧都不压缩
+                if (_compression) {
+                    char codecs = static_cast<char>(Compression::SupportedCodecs());
+                    Send(&codecs, 1, MSG_HELLO);
+                }
                 do_read_header();
+                // 断线期间留在队列里的帧按旧连接协商的算法压缩过，新连接还没协商，先还原成不压缩的帧；
+                // 旧连接的写操作还没回调时队首仍归它所有，由它回调时处理
+                for (size_t i = _writing ? 1 : 0; i < _send_queue.size(); ++i) {
+                    StripCompression(_send_queue[i]);
+                }
+                // 连接之前（或断线期间）排队的帧从队首开始发送
+                if (!_send_queue.empty() && !_writing) {
+                    do_write();
+                }
             } else {
-                cout << "connect failed, code is " << ec.value() << " error msg is " << ec.message() << endl;
+                LOG_ERROR("connect failed, code is ", ec.value(), " error msg is ", ec.message());
+            }
+            if (_connect_handler) {
+                _connect_handler(ec);
+            }
+            if (ec) {
+                HandleDisconnect(ec);
             }
         });
 }
 
 void AsyncClient::do_read_header() {
     boost::asio::async_read(_socket,
-        boost::asio::buffer(_recv_head, HEAD_LENGTH),
-        [this](boost::system::error_code ec, size_t /*length*/) {
+        boost::asio::buffer(_recv_head, MSG_HEAD_LENGTH),
+        [this, generation = _generation](boost::system::error_code ec, size_t /*length*/) {
+            if (generation != _generation) {
+                return;
+            }
             if (!ec) {
-                short msglen = 0;
-                memcpy(&msglen, _recv_head, HEAD_LENGTH);
-                do_read_body(msglen);
+                MsgHeader head = DecodeMsgHeader(_recv_head);
+                if (head.version != MSG_HEAD_VERSION || head.length > _max_frame_size) {
+                    LOG_WARN("Invalid message header, version: ", head.version, ", length: ", head.length);
+                    HandleDisconnect(make_error_code(boost::system::errc::protocol_error));
+                    return;
+                }
+                do_read_body(static_cast<short>(head.msg_id), head.flags, head.length);
             } else {
-                cout << "Read header failed: " << ec.message() << endl;
-                Close();
+                LOG_WARN("Read header failed: ", ec.message());
+                HandleDisconnect(ec);
             }
         });
 }
 
-void AsyncClient::do_read_body(short msglen) {
+void AsyncClient::do_read_body(short msg_id, uint8_t flags, uint32_t msglen) {
     _recv_msg.resize(msglen);
     boost::asio::async_read(_socket,
         boost::asio::buffer(_recv_msg, msglen),
-        [this, msglen](boost::system::error_code ec, size_t /*length*/) {
+        [this, msg_id, flags, msglen, generation = _generation](boost::system::error_code ec, size_t /*length*/) {
+            if (generation != _generation) {
+                return;
+            }
             if (!ec) {
-                cout << "Reply is: ";
-                cout.write(_recv_msg.data(), msglen);
-                cout << endl;
-                cout << "Reply len is " << msglen << endl;
+                // 协商回复：只有自己声明过的算法才会被采用
+                if (msg_id == MSG_HELLO) {
+                    uint8_t codec = msglen > 0 ? static_cast<uint8_t>(_recv_msg[0]) : 0;
+                    _codec.store(_compression ? (codec & Compression::SupportedCodecs()) : 0, std::memory_order_relaxed);
+                    LOG_INFO("Negotiated compression codec: ", static_cast<int>(GetCodec()));
+                    do_read_header();
+                    return;
+                }
+                const char* data = _recv_msg.data();
+                uint32_t length = msglen;
+                // 回复帧：剥掉请求ID，解压后交给对应的在途请求
+                uint32_t request_id = 0;
+                if (flags & MSG_FLAG_REPLY) {
+                    if (length < MSG_REQUEST_ID_LENGTH) {
+                        LOG_WARN("Invalid reply frame, length: ", length);
+                        HandleDisconnect(make_error_code(boost::system::errc::protocol_error));
+                        return;
+                    }
+                    request_id = DecodeRequestId(data);
+                    data += MSG_REQUEST_ID_LENGTH;
+                    length -= MSG_REQUEST_ID_LENGTH;
+                }
+                uint8_t codec = flags & MSG_FLAG_COMPRESSED;
+                if (codec != 0) {
+                    // 解压后的长度同样受最大帧长度限制
+                    uint32_t original = 0;
+                    if (!Compression::OriginalLength(data, length, original) || original > _max_frame_size) {
+                        LOG_WARN("Invalid compressed frame, length: ", length);
+                        HandleDisconnect(make_error_code(boost::system::errc::protocol_error));
+                        return;
+                    }
+                    _recv_inflated.resize(original);
+                    if (!Compression::Decompress(codec, data, length, _recv_inflated.data(), original)) {
+                        LOG_WARN("Failed to decompress frame, codec: ", static_cast<int>(codec));
+                        HandleDisconnect(make_error_code(boost::system::errc::protocol_error));
+                        return;
+                    }
+                    data = _recv_inflated.data();
+                    length = original;
+                }
+                if (request_id != 0) {
+                    CompleteRequest(request_id, msg_id, data, length);
+                } else if (_message_handler) {
+                    _message_handler(msg_id, data, length);
+                } else {
+                    LOG_DEBUG("Reply [", msg_id, "] is: ", std::string_view(data, length), ", len is ", length);
+                }
                 do_read_header();
             } else {
-                cout << "Read body failed: " << ec.message() << endl;
-                Close();
+                LOG_WARN("Read body failed: ", ec.message());
+                HandleDisconnect(ec);
             }
         });
 }
 
 void AsyncClient::do_write() {
+    _writing = true;
     auto& data = _send_queue.front();
     boost::asio::async_write(_socket,
         boost::asio::buffer(data),
-        [this](boost::system::error_code ec, size_t /*length*/) {
+        [this, generation = _generation](boost::system::error_code ec, size_t /*length*/) {
+            _writing = false;
             if (!ec) {
-                _send_queue.pop();
-                if (!_send_queue.empty()) {
-                    do_write();
+                // 写完即出队，即使连接已经因为读错误断开：帧已经交给内核，重连后不能再发一次
+                bool request = static_cast<uint8_t>(_send_queue.front()[1]) & MSG_FLAG_REQUEST;
+                uint32_t request_id = request ? DecodeRequestId(_send_queue.front().data() + MSG_HEAD_LENGTH) : 0;
+                size_t queued = _queued_bytes.fetch_sub(_send_queue.front().size(), std::memory_order_relaxed)
+                    - _send_queue.front().size();
+                _send_queue.pop_front();
+                if (_backpressure && queued <= _send_low_water) {
+                    _backpressure = false;
+                    if (_backpressure_handler) {
+                        _backpressure_handler(false);
+                    }
                 }
-            } else {
-                cout << "Write failed: " << ec.message() << endl;
-                Close();
+                if (generation != _generation && request_id != 0) {
+                    // 断开时它还在队列中，FailSentRequests 没有处理；回复随旧连接丢失
+                    FailRequest(request_id, _disconnect_error);
+                }
+            } else if (generation == _generation) {
+                LOG_WARN("Write failed: ", ec.message());
+                HandleDisconnect(ec);
+                return;
+            } else if (!_send_queue.empty()) {
+                // 旧连接上没写完的队首留待重连后重发，新连接可能已经建立但还没协商压缩
+                StripCompression(_send_queue.front());
+            }
+            // 属于旧连接的回调：新连接已经建立时由这里接着发送（连接成功时看到 _writing 没有开始写）
+            if (_state == State::CONNECTED && !_send_queue.empty()) {
+                do_write();
             }
         });
 }
+
+void AsyncClient::StripCompression(vector<char>& frame) {
+    uint8_t flags = static_cast<uint8_t>(frame[1]);
+    uint8_t codec = flags & MSG_FLAG_COMPRESSED;
+    if (codec == 0) {
+        return;
+    }
+    size_t prefix = (flags & MSG_FLAG_REQUEST) ? MSG_REQUEST_ID_LENGTH : 0;
+    const char* body = frame.data() + MSG_HEAD_LENGTH + prefix;
+    size_t length = frame.size() - MSG_HEAD_LENGTH - prefix;
+    // 帧是自己压缩的，原始长度不超过 _max_frame_size，这里不会失败
+    uint32_t original = 0;
+    vector<char> plain(MSG_HEAD_LENGTH + prefix);
+    if (!Compression::OriginalLength(body, length, original)) {
+        return;
+    }
+    plain.resize(MSG_HEAD_LENGTH + prefix + original);
+    if (!Compression::Decompress(codec, body, length, plain.data() + MSG_HEAD_LENGTH + prefix, original)) {
+        return;
+    }
+    MsgHeader head = DecodeMsgHeader(frame.data());
+    head.flags = flags & ~MSG_FLAG_COMPRESSED;
+    head.length = static_cast<uint32_t>(prefix + original);
+    EncodeMsgHeader(plain.data(), head);
+    memcpy(plain.data() + MSG_HEAD_LENGTH, frame.data() + MSG_HEAD_LENGTH, prefix);
+    // 排队字节数按还原后的大小计，可能暂时超过硬上限
+    _queued_bytes.fetch_add(plain.size() - frame.size(), std::memory_order_relaxed);
+    frame = std::move(plain);
+}
@@ -1,32 +1,218 @@
 #pragma once
 #include <iostream>
 #include <boost/asio.hpp>
-#include <queue>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <queue>
+#include <unordered_map>
 #include <vector>
+#include "../Common/Logger.h"
+#include "../Common/MsgHeader.h"
+#include "../Common/MsgId.h"
+#include "../Common/MsgSchema.h"
+#include "../Common/SocketOptions.h"
+#include "../Common/Compression.h"
 
 using namespace boost::asio::ip;
 using namespace std;
 
+// 请求的回复：消息ID和消息体（已解压）
+struct RpcReply {
+    short msg_id = 0;
+    vector<char> data;
+};
+
 class AsyncClient {
 public:
-    AsyncClient(boost::asio::io_context& ioc, const string& ip, int port);
+    // 收到一条完整回复时的回调，在 IO 线程上执行，data 仅在回调期间有效
+    using MessageHandler = function<void(short msg_id, const char* data, size_t length)>;
+    // 每次连接尝试完成（成功或失败，包括重连）时的回调，在 IO 线程上执行
+    using ConnectHandler = function<void(const boost::system::error_code& ec)>;
+    // 发送队列越过高水位 (paused = true) / 回落到低水位以下 (paused = false) 时的回调，在 IO 线程上执行
+    using BackpressureHandler = function<void(bool paused)>;
+
+    // max_frame_size: 允许收发的最大消息体长度，应与服务器的配置一致
+    // socket_options: connect 之前设置的套接字选项，默认开启 TCP_NODELAY
+    AsyncClient(boost::asio::io_context& ioc, const string& ip, int port, uint32_t max_frame_size = 64 * 1024,
+        const SocketOptions& socket_options = SocketOptions());
+    // 关闭连接且不再重连，可在任意线程调用；在途的请求以 operation_aborted 完成
     void Close();
-    void Send(const string& msg);
+    // 可在任意线程调用；发送队列超过硬上限或消息过长时丢弃并返回 false
+    bool Send(const string& msg, short msg_id = MSG_ECHO);
+    bool Send(const char* data, size_t length, short msg_id = MSG_ECHO);
+    // 发送一条类型化消息（见 MsgSchema.h）：在调用线程的栈上编码，消息ID取 Msg::MSG_ID
+    template <TypedMsg Msg>
+    bool Send(const Msg& msg) {
+        std::array<char, MsgWireSize<Msg>> body;
+        EncodeMsg(msg, body.data());
+        return Send(body.data(), body.size(), static_cast<short>(Msg::MSG_ID));
+    }
+
+    // 发送一个请求（MSG_FLAG_REQUEST），对端以同一请求ID回复后完成；可在任意线程调用，同一连接上可以有任意多个请求在途。
+    // token 是 Boost.Asio 的完成令牌，完成签名为 void(error_code, RpcReply)：可以是回调、use_future、use_awaitable 等。
+    // 消息在调用线程上封包，data 在调用返回后即可释放。完成时的错误：
+    //   timed_out: timeout 内没有收到回复，之后到达的回复被丢弃
+    //   message_size / no_buffer_space: 消息过长 / 发送队列超过硬上限，请求没有发出
+    //   其他: 连接断开或 Close()，所有在途的请求以该错误完成
+    // 完成回调通过令牌关联的执行器调用，默认在 IO 线程上；回复不经过 SetMessageHandler 设置的回调。
+    template <typename CompletionToken>
+    auto AsyncRequest(const char* data, size_t length, short msg_id, std::chrono::milliseconds timeout, CompletionToken&& token) {
+        // 封包必须在这里立即完成：use_awaitable 等延迟令牌直到 co_await 时才调用发起函数，那时 data 可能已经失效。
+        // 延迟令牌得到的操作必须被启动，否则已计入的排队字节数不会归还
+        uint32_t request_id = NextRequestId();
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        vector<char> frame;
+        boost::system::error_code ec = PrepareFrame(data, length, msg_id, request_id, frame);
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code, RpcReply)>(
+            [this, request_id, deadline, ec, frame = std::move(frame)](auto handler) mutable {
+                using Handler = decltype(handler);
+                StartRequest(request_id, ec, std::move(frame), deadline,
+                    std::make_unique<RequestCompletionImpl<Handler>>(std::move(handler)));
+            }, token);
+    }
+    // 发送一个类型化请求（见 MsgSchema.h），回复的消息体可用 DecodeMsg 解码
+    template <TypedMsg Msg, typename CompletionToken>
+    auto AsyncRequest(const Msg& msg, std::chrono::milliseconds timeout, CompletionToken&& token) {
+        std::array<char, MsgWireSize<Msg>> body;
+        EncodeMsg(msg, body.data());
+        return AsyncRequest(body.data(), body.size(), static_cast<short>(Msg::MSG_ID), timeout, std::forward<CompletionToken>(token));
+    }
+    // 等待回复的请求数，只在 IO 线程上读取
+    size_t GetPendingRequests() const { return _pending.size(); }
+
+    // 需在 io_context 开始运行前设置
+    // 断线自动重连：连接失败或断开后按带抖动的指数退避重连，等待时间从 min_delay 起每次翻倍，不超过 max_delay。
+    // 断开时没写完的帧（包括写了一半的队首）留在发送队列中，重连成功后从头重发；已经写出的请求以断开的错误完成，
+    // 还在队列中的请求继续等待回复。未开启时连接出错即彻底关闭。
+    void SetReconnect(bool enable, std::chrono::milliseconds min_delay = std::chrono::milliseconds(100),
+        std::chrono::milliseconds max_delay = std::chrono::milliseconds(10000));
+    void SetMessageHandler(MessageHandler handler);
+    void SetConnectHandler(ConnectHandler handler);
+    void SetBackpressureHandler(BackpressureHandler handler);
+    // 发送队列的高/低水位和硬上限（字节），默认 1MB / 256KB / 16MB
+    void SetSendQueueLimits(size_t high_water, size_t low_water, size_t limit);
+    // 开启单帧压缩：连接建立后发送 MSG_HELLO 协商算法，服务器回复后对不小于 threshold 字节的消息压缩发送
+    // 收到的压缩帧总是会解压，与是否开启无关
+    void SetCompression(bool enable, uint32_t threshold = 1024);
+    // 协商得到的压缩算法（MSG_FLAG_LZ4 / MSG_FLAG_ZLIB），0 表示不压缩
+    uint8_t GetCodec() const { return _codec.load(std::memory_order_relaxed); }
+
+    // 当前是否已连接，可在任意线程读取
+    bool IsConnected() const { return _connected.load(std::memory_order_relaxed); }
+    // 发送队列中尚未写完的字节数，可在任意线程读取
+    size_t GetQueuedBytes() const { return _queued_bytes.load(std::memory_order_relaxed); }
+    // 因超过硬上限而丢弃的消息数
+    uint64_t GetDroppedMessages() const { return _dropped_messages.load(std::memory_order_relaxed); }
 
 private:
+    // 在途请求的完成回调，按完成令牌生成的处理函数类型擦除
+    struct RequestCompletion {
+        virtual ~RequestCompletion() = default;
+        virtual void Complete(const boost::system::error_code& ec, RpcReply reply) = 0;
+    };
+    template <typename Handler>
+    struct RequestCompletionImpl final : RequestCompletion {
+        explicit RequestCompletionImpl(Handler handler) : _handler(std::move(handler)) {}
+        void Complete(const boost::system::error_code& ec, RpcReply reply) override {
+            // 在处理函数关联的执行器上调用（use_future 等没有关联执行器时就在当前的 IO 线程上）
+            auto executor = boost::asio::get_associated_executor(_handler);
+            boost::asio::dispatch(executor, [handler = std::move(_handler), ec, reply = std::move(reply)]() mutable {
+                handler(ec, std::move(reply));
+            });
+        }
+        Handler _handler;
+    };
+
     void do_connect();
     void do_read_header();
-    void do_read_body(short msglen);
+    void do_read_body(short msg_id, uint8_t flags, uint32_t msglen);
     void do_write();
+    // 在调用线程上封包并计入排队字节数；request_id 不为 0 时作为请求发送。消息过长或超过硬上限时返回错误，不计入
+    boost::system::error_code PrepareFrame(const char* data, size_t length, short msg_id, uint32_t request_id, vector<char>& frame);
+    // 在 IO 线程上把封好的帧加入发送队列
+    void QueueFrame(vector<char> frame);
+    // 分配请求ID，任意线程调用，跳过 0
+    uint32_t NextRequestId();
+    // 把 AsyncRequest 封好的帧交给 IO 线程：ec 不为空时（封包失败）直接以该错误完成
+    void StartRequest(uint32_t request_id, boost::system::error_code ec, vector<char> frame,
+        std::chrono::steady_clock::time_point deadline, unique_ptr<RequestCompletion> completion);
+    // 以下只在 IO 线程上调用
+    void CompleteRequest(uint32_t request_id, short msg_id, const char* data, size_t length);
+    void ArmRequestTimer(std::chrono::steady_clock::time_point deadline);
+    void HandleRequestTimer(const boost::system::error_code& ec);
+    // 连接断开时让所有在途请求以 ec 完成
+    void FailPendingRequests(const boost::system::error_code& ec);
+    // 重连前让已经写出（不在发送队列中）的请求以 ec 完成，队列中的请求随帧重发
+    void FailSentRequests(const boost::system::error_code& ec);
+    // 在途请求以 ec 完成（已完成或超时的忽略）
+    void FailRequest(uint32_t request_id, const boost::system::error_code& ec);
+    // 把按旧连接协商的算法压缩过的帧还原成不压缩的帧，重连后、协商完成前发送
+    void StripCompression(vector<char>& frame);
+    // 连接失败、读写出错或收到非法帧时在 IO 线程上调用：关闭套接字，按设置等待重连或彻底关闭
+    void HandleDisconnect(const boost::system::error_code& ec);
+    void ScheduleReconnect();
 
 private:
     tcp::socket _socket;
     tcp::endpoint _endpoint;
+    SocketOptions _socket_options;
+
+    // 连接状态，只在 IO 线程上访问
+    enum class State { CONNECTING, CONNECTED, WAITING_RECONNECT, CLOSED };
+    State _state = State::CONNECTING;
+    // 每次断开加一：异步回调捕获发起时的值，与当前值不同说明属于已断开的旧连接，直接忽略
+    uint64_t _generation = 0;
+    atomic<bool> _connected{false};
+    bool _reconnect = false;
+    std::chrono::milliseconds _reconnect_min_delay{100};
+    std::chrono::milliseconds _reconnect_max_delay{10000};
+    unsigned _reconnect_attempts = 0;
+    boost::asio::steady_timer _reconnect_timer;
+
+    // 待发送的帧，队首正在写；断开时保留，重连后从队首开始重发
+    deque<vector<char>> _send_queue;
+    // 是否有 async_write 在进行（可能属于已断开的旧连接），只在 IO 线程上访问
+    bool _writing = false;
+    // 最近一次断开的原因：旧连接上写完的请求随后以它完成
+    boost::system::error_code _disconnect_error;
     
-    queue<vector<char>> _send_queue;
-    
-    enum { HEAD_LENGTH = 2, MAX_LENGTH = 1024 * 2 };
-    char _recv_head[HEAD_LENGTH];
+    uint32_t _max_frame_size;
+    char _recv_head[MSG_HEAD_LENGTH];
     vector<char> _recv_msg;
+    // 压缩帧解压后的消息体，连接内复用
+    vector<char> _recv_inflated;
+
+    MessageHandler _message_handler;
+    ConnectHandler _connect_handler;
+    BackpressureHandler _backpressure_handler;
+
+    size_t _send_high_water = 1024 * 1024;
+    size_t _send_low_water = 256 * 1024;
+    size_t _send_queue_limit = 16 * 1024 * 1024;
+    // 已提交但尚未写完的字节数：Send 时增加，写完后减少
+    atomic<size_t> _queued_bytes{0};
+    atomic<uint64_t> _dropped_messages{0};
+    // 是否已越过高水位，只在 IO 线程上访问
+    bool _backpressure = false;
+
+    bool _compression = false;
+    uint32_t _compress_threshold = 1024;
+    // 协商得到的压缩算法：IO 线程收到 MSG_HELLO 回复时设置，Send 在调用线程上读取
+    atomic<uint8_t> _codec{0};
+
+    // 请求ID，任意线程分配，跳过 0
+    atomic<uint32_t> _next_request_id{1};
+    // 在途请求，只在 IO 线程上访问
+    unordered_map<uint32_t, unique_ptr<RequestCompletion>> _pending;
+    // 截止时间的小顶堆：回复到达时不从堆中删除，到期或回复按序到达时再顺带弹出已完成的项
+    using Deadline = pair<std::chrono::steady_clock::time_point, uint32_t>;
+    priority_queue<Deadline, vector<Deadline>, greater<Deadline>> _deadlines;
+    // 所有请求共用一个定时器，总是指向最早的截止时间
+    boost::asio::steady_timer _request_timer;
+    std::chrono::steady_clock::time_point _request_timer_expiry = std::chrono::steady_clock::time_point::max();
 };
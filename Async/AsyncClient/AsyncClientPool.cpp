@@ -0,0 +1,98 @@
+#include "AsyncClientPool.h"
+#include <limits>
+#include <stdexcept>
+
+AsyncClientPool::AsyncClientPool(const vector<boost::asio::io_context*>& iocs, const vector<Endpoint>& endpoints,
+    size_t connections, uint32_t max_frame_size, const SocketOptions& socket_options) {
+    if (iocs.empty() || endpoints.empty() || connections == 0) {
+        throw std::invalid_argument("AsyncClientPool needs at least one io_context, endpoint and connection");
+    }
+    _clients.reserve(connections);
+    for (size_t i = 0; i < connections; ++i) {
+        const Endpoint& endpoint = endpoints[i % endpoints.size()];
+        auto client = make_unique<AsyncClient>(*iocs[i % iocs.size()], endpoint.ip, endpoint.port, max_frame_size, socket_options);
+        client->SetReconnect(true);
+        _clients.push_back(std::move(client));
+    }
+}
+
+AsyncClientPool::AsyncClientPool(boost::asio::io_context& ioc, const vector<Endpoint>& endpoints, size_t connections,
+    uint32_t max_frame_size, const SocketOptions& socket_options)
+    : AsyncClientPool(vector<boost::asio::io_context*>{&ioc}, endpoints, connections, max_frame_size, socket_options) {
+}
+
+void AsyncClientPool::SetReconnect(std::chrono::milliseconds min_delay, std::chrono::milliseconds max_delay) {
+    for (auto& client : _clients) {
+        client->SetReconnect(true, min_delay, max_delay);
+    }
+}
+
+void AsyncClientPool::SetMessageHandler(AsyncClient::MessageHandler handler) {
+    for (auto& client : _clients) {
+        client->SetMessageHandler(handler);
+    }
+}
+
+void AsyncClientPool::SetConnectHandler(ConnectHandler handler) {
+    for (size_t i = 0; i < _clients.size(); ++i) {
+        _clients[i]->SetConnectHandler([handler, i](const boost::system::error_code& ec) {
+            handler(i, ec);
+        });
+    }
+}
+
+void AsyncClientPool::SetCompression(bool enable, uint32_t threshold) {
+    for (auto& client : _clients) {
+        client->SetCompression(enable, threshold);
+    }
+}
+
+bool AsyncClientPool::Send(const string& msg, short msg_id) {
+    return Pick().Send(msg, msg_id);
+}
+
+bool AsyncClientPool::Send(const char* data, size_t length, short msg_id) {
+    return Pick().Send(data, length, msg_id);
+}
+
+void AsyncClientPool::Close() {
+    for (auto& client : _clients) {
+        client->Close();
+    }
+}
+
+size_t AsyncClientPool::GetConnectedCount() const {
+    size_t count = 0;
+    for (const auto& client : _clients) {
+        count += client->IsConnected() ? 1 : 0;
+    }
+    return count;
+}
+
+size_t AsyncClientPool::GetQueuedBytes() const {
+    size_t bytes = 0;
+    for (const auto& client : _clients) {
+        bytes += client->GetQueuedBytes();
+    }
+    return bytes;
+}
+
+AsyncClient& AsyncClientPool::Pick() {
+    // 连接数通常只有几个到几十个，逐个读原子计数比维护有序结构便宜；读到的值可能稍旧，只影响均衡程度
+    size_t count = _clients.size();
+    size_t start = _next.fetch_add(1, std::memory_order_relaxed) % count;
+    AsyncClient* best = nullptr;
+    bool best_connected = false;
+    size_t best_bytes = std::numeric_limits<size_t>::max();
+    for (size_t k = 0; k < count; ++k) {
+        AsyncClient* client = _clients[(start + k) % count].get();
+        bool connected = client->IsConnected();
+        size_t bytes = client->GetQueuedBytes();
+        if (best == nullptr || (connected && !best_connected) || (connected == best_connected && bytes < best_bytes)) {
+            best = client;
+            best_connected = connected;
+            best_bytes = bytes;
+        }
+    }
+    return *best;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AsyncClient.h"
+
+// AsyncClientPool: 到一个或多个服务器端点的一组 AsyncClient 连接
+// 设计原理：
+// 1. 单个连接的吞吐受一条 TCP 流（一个发送队列、一个读循环）限制，多个连接分担后总吞吐随连接数增长。
+// 2. 连接按轮询分配到各个端点和 io_context 上，全部开启断线重连（带抖动的指数退避），断线期间没写完的帧重连后重发。
+// 3. Send / AsyncRequest 选择排队字节数最少的已连接连接；全部断开时选择排队最少的连接，帧在重连后发出。
+//    扫描起点每次轮转一位，排队字节数相同（例如都为 0）时各连接轮流分担。
+class AsyncClientPool {
+public:
+    struct Endpoint {
+        string ip;
+        int port;
+    };
+    // 某个连接的一次连接尝试完成（成功或失败，包括重连）时的回调，index 为连接下标，在该连接的 IO 线程上执行
+    using ConnectHandler = function<void(size_t index, const boost::system::error_code& ec)>;
+
+    // iocs: 连接按轮询分配到这些 io_context 上，每个 io_context 由一个线程运行
+    // connections: 连接总数，按轮询分配到 endpoints 上
+    AsyncClientPool(const vector<boost::asio::io_context*>& iocs, const vector<Endpoint>& endpoints, size_t connections,
+        uint32_t max_frame_size = 64 * 1024, const SocketOptions& socket_options = SocketOptions());
+    AsyncClientPool(boost::asio::io_context& ioc, const vector<Endpoint>& endpoints, size_t connections,
+        uint32_t max_frame_size = 64 * 1024, const SocketOptions& socket_options = SocketOptions());
+
+    AsyncClientPool(const AsyncClientPool&) = delete;
+    AsyncClientPool& operator=(const AsyncClientPool&) = delete;
+
+    // 以下设置需在 io_context 开始运行前调用，对所有连接生效
+    void SetReconnect(std::chrono::milliseconds min_delay, std::chrono::milliseconds max_delay);
+    // 消息回调可能在多个 IO 线程上并发执行
+    void SetMessageHandler(AsyncClient::MessageHandler handler);
+    void SetConnectHandler(ConnectHandler handler);
+    void SetCompression(bool enable, uint32_t threshold = 1024);
+
+    // 可在任意线程调用，选择排队字节数最少的连接发送；被选中的连接排队超过硬上限时返回 false
+    bool Send(const string& msg, short msg_id = MSG_ECHO);
+    bool Send(const char* data, size_t length, short msg_id = MSG_ECHO);
+    template <TypedMsg Msg>
+    bool Send(const Msg& msg) {
+        return Pick().Send(msg);
+    }
+    // 同 AsyncClient::AsyncRequest，请求和回复都在被选中的连接上
+    template <typename CompletionToken>
+    auto AsyncRequest(const char* data, size_t length, short msg_id, std::chrono::milliseconds timeout, CompletionToken&& token) {
+        return Pick().AsyncRequest(data, length, msg_id, timeout, std::forward<CompletionToken>(token));
+    }
+    template <TypedMsg Msg, typename CompletionToken>
+    auto AsyncRequest(const Msg& msg, std::chrono::milliseconds timeout, CompletionToken&& token) {
+        return Pick().AsyncRequest(msg, timeout, std::forward<CompletionToken>(token));
+    }
+
+    // 关闭所有连接，不再重连
+    void Close();
+
+    size_t Size() const { return _clients.size(); }
+    AsyncClient& GetClient(size_t index) { return *_clients[index]; }
+    // 当前已连接的连接数，可在任意线程读取
+    size_t GetConnectedCount() const;
+    // 所有连接排队字节数之和，可在任意线程读取
+    size_t GetQueuedBytes() const;
+
+private:
+    // 选择发送的连接：已连接优先，其次排队字节数最少
+    AsyncClient& Pick();
+
+    vector<unique_ptr<AsyncClient>> _clients;
+    // 扫描起点，每次 Pick 加一
+    atomic<size_t> _next{0};
+};
@@ -0,0 +1,111 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../Common/BufferPool.h"
+#include "../Common/MpscQueue.h"
+#include "../Common/MsgId.h"
+#include "../v2_FullDuplex/MsgNode.h"
+
+using namespace std;
+
+// BufferPool 微基准：
+// 1. 同线程创建/销毁：make_shared + new[] 对比 MsgNode::Create（节点、消息体、控制块同一个池）
+// 2. 跨线程：生产者线程创建 MsgNode 经 MpscQueue 交给消费者线程释放，模拟 IO 线程收包、逻辑线程处理完释放。
+//    统计每条消息的池未命中次数，验证远程释放栈让块回到分配线程
+// 用法：BufferPoolBench [消息数]
+
+namespace{
+
+// 对照组：原来的 MsgNode 写法
+struct PlainNode{
+    int _total_len;
+    char* _msg;
+    PlainNode(const char* msg, int len):_total_len(len + MSG_HEAD_LENGTH){
+        _msg = new char[_total_len + 1];
+        memcpy(_msg + MSG_HEAD_LENGTH, msg, len);
+    }
+    ~PlainNode(){
+        delete[] _msg;
+    }
+};
+
+double Elapsed(chrono::steady_clock::time_point start, int count){
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
+
+int PayloadSize(int i){
+    return 64 + (i % 8) * 200; // 64 ~ 1464 字节
+}
+
+void SameThread(const char* payload, int count){
+    vector<shared_ptr<PlainNode>> plain;
+    vector<shared_ptr<MsgNode>> pooled;
+    auto start = chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i){
+        plain.push_back(make_shared<PlainNode>(payload, PayloadSize(i)));
+        if(plain.size() == 16){
+            plain.clear();
+        }
+    }
+    double plain_ns = Elapsed(start, count);
+    auto before = BufferPool::GetStats();
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i){
+        pooled.push_back(MsgNode::Create(payload, PayloadSize(i), MSG_ECHO));
+        if(pooled.size() == 16){
+            pooled.clear();
+        }
+    }
+    double pooled_ns = Elapsed(start, count);
+    auto after = BufferPool::GetStats();
+    printf("same thread:  make_shared+new[] %.1f ns/msg, pooled %.1f ns/msg, misses/msg %.4f\n",
+        plain_ns, pooled_ns, double(after.misses - before.misses) / count);
+}
+
+void CrossThread(const char* payload, int count){
+    MpscQueue<shared_ptr<MsgNode>> queue;
+    atomic<int> in_flight{0};
+    auto before = BufferPool::GetStats();
+    auto start = chrono::steady_clock::now();
+    thread consumer([&](){
+        shared_ptr<MsgNode> node;
+        for(int done = 0; done < count;){
+            if(queue.Pop(node)){
+                node.reset();
+                in_flight.fetch_sub(1, memory_order_relaxed);
+                ++done;
+            }else{
+                this_thread::yield();
+            }
+        }
+    });
+    for(int i = 0; i < count; ++i){
+        // 在途上限与一个会话批量处理的量级相当
+        while(in_flight.load(memory_order_relaxed) >= 1024){
+            this_thread::yield();
+        }
+        in_flight.fetch_add(1, memory_order_relaxed);
+        queue.Push(MsgNode::Create(payload, PayloadSize(i), MSG_ECHO));
+    }
+    consumer.join();
+    double ns = Elapsed(start, count);
+    auto after = BufferPool::GetStats();
+    printf("cross thread: %.1f ns/msg, misses/msg %.4f, remote frees/msg %.2f\n",
+        ns, double(after.misses - before.misses) / count, double(after.remote_frees - before.remote_frees) / count);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int count = argc > 1 ? atoi(argv[1]) : 2000000;
+    vector<char> payload(2048, 'x');
+    for(int round = 0; round < 2; ++round){
+        SameThread(payload.data(), count);
+        CrossThread(payload.data(), count);
+    }
+    return 0;
+}
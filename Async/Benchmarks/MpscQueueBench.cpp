@@ -0,0 +1,88 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "../Common/MpscQueue.h"
+
+using namespace std;
+
+// MpscQueue 微基准：N 个生产者线程同时入队同一个 shared_ptr，一个消费者线程出队，
+// 对比 Session 原来的 mutex + std::queue 发送队列，输出每条消息的平均耗时（从生产者开始入队到消费者取完）。
+// 单核上生产者只能轮流运行，锁几乎不会被争用，测到的只是单次操作的开销；争用下的差别要在多核上测。
+// 用法：MpscQueueBench [消息总数]
+
+namespace{
+
+using Item = shared_ptr<int>;
+
+template <typename PushFn, typename PopFn>
+double Run(int producers, int per_producer, PushFn push, PopFn pop){
+    atomic<bool> go{false};
+    vector<thread> threads;
+    auto item = make_shared<int>(1);
+    for(int p = 0; p < producers; ++p){
+        threads.emplace_back([&](){
+            while(!go.load(memory_order_acquire)){
+            }
+            for(int i = 0; i < per_producer; ++i){
+                push(item);
+            }
+        });
+    }
+    long total = long(producers) * per_producer;
+    long done = 0;
+    Item value;
+    auto start = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    while(done < total){
+        if(pop(value)){
+            ++done;
+        }else{
+            this_thread::yield();
+        }
+    }
+    for(auto& t : threads){
+        t.join();
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / total;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int count = argc > 1 ? atoi(argv[1]) : 2000000;
+    printf("hardware threads: %u\n", thread::hardware_concurrency());
+    for(int producers : {1, 2, 4, 16}){
+        int per_producer = count / producers;
+
+        mutex lock;
+        queue<Item> locked_queue;
+        double locked_ns = Run(producers, per_producer,
+            [&](const Item& v){
+                lock_guard<mutex> guard(lock);
+                locked_queue.push(v);
+            },
+            [&](Item& v){
+                lock_guard<mutex> guard(lock);
+                if(locked_queue.empty()){
+                    return false;
+                }
+                v = std::move(locked_queue.front());
+                locked_queue.pop();
+                return true;
+            });
+
+        MpscQueue<Item> mpsc;
+        double mpsc_ns = Run(producers, per_producer,
+            [&](const Item& v){ mpsc.Push(v); },
+            [&](Item& v){ return mpsc.Pop(v); });
+
+        printf("%2d producers: mutex+queue %.1f ns/msg, MpscQueue %.1f ns/msg\n", producers, locked_ns, mpsc_ns);
+    }
+    return 0;
+}
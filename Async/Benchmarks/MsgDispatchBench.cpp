@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "../Common/Messages.h"
+#include "../Common/MsgDispatch.h"
+
+using namespace std;
+
+// MsgDispatch 微基准：6 条路由（5 条原始消息、1 条类型化的 PositionMsg），处理函数只做一次加法，
+// 静态跳转表对比 std::map / std::unordered_map + std::function。
+// 模式 0：消息ID在 6 个中随机（分支预测失败为主）；模式 1：每帧都是同一个ID。
+// 用法：MsgDispatchBench [模式] [帧数]
+
+namespace{
+
+struct Ctx{
+    uint64_t sum = 0;
+};
+
+void OnA(Ctx& ctx, short msg_id, const char* /*data*/, int length){
+    ctx.sum += msg_id + length;
+}
+void OnB(Ctx& ctx, short /*msg_id*/, const char* data, int /*length*/){
+    ctx.sum += data[0];
+}
+void OnC(Ctx& ctx, short /*msg_id*/, const char* /*data*/, int length){
+    ctx.sum ^= length;
+}
+void OnPosition(Ctx& ctx, const PositionMsg& msg){
+    ctx.sum += msg.seq;
+}
+
+using Dispatcher = MsgDispatcher<Ctx&,
+    RawRoute<1001, &OnA>, RawRoute<1002, &OnB>, RawRoute<1003, &OnC>,
+    TypedRoute<&OnPosition>, RawRoute<1010, &OnA>, RawRoute<1020, &OnB>>;
+
+using Callback = function<void(Ctx&, short, const char*, int)>;
+
+double Elapsed(chrono::steady_clock::time_point start, int count){
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int mode = argc > 1 ? atoi(argv[1]) : 0;
+    int count = argc > 2 ? atoi(argv[2]) : 20000000;
+
+    map<short, Callback> callbacks;
+    callbacks[1001] = OnA;
+    callbacks[1002] = OnB;
+    callbacks[1003] = OnC;
+    callbacks[PositionMsg::MSG_ID] = [](Ctx& ctx, short, const char* data, int length){
+        PositionMsg msg;
+        if(DecodeMsg(data, length, msg)){
+            OnPosition(ctx, msg);
+        }
+    };
+    callbacks[1010] = OnA;
+    callbacks[1020] = OnB;
+    unordered_map<short, Callback> hashed(callbacks.begin(), callbacks.end());
+
+    const short ids[] = {1001, 1002, 1003, static_cast<short>(PositionMsg::MSG_ID), 1010, 1020};
+    mt19937 rng(1);
+    vector<short> sequence(1 << 16);
+    for(auto& id : sequence){
+        id = mode == 0 ? ids[rng() % 6] : 1001;
+    }
+    // 所有帧共用一个 PositionMsg 大小的消息体，原始消息不关心内容
+    char body[MsgWireSize<PositionMsg>] = {1};
+    PositionMsg position;
+    position.seq = 5;
+    EncodeMsg(position, body);
+    const int length = sizeof(body);
+
+    for(int round = 0; round < 3; ++round){
+        Ctx table_ctx, map_ctx, hashed_ctx;
+        auto start = chrono::steady_clock::now();
+        for(int i = 0; i < count; ++i){
+            Dispatcher::Dispatch(table_ctx, sequence[i & 0xffff], body, length);
+        }
+        double table_ns = Elapsed(start, count);
+        start = chrono::steady_clock::now();
+        for(int i = 0; i < count; ++i){
+            short id = sequence[i & 0xffff];
+            auto iter = callbacks.find(id);
+            if(iter != callbacks.end()){
+                iter->second(map_ctx, id, body, length);
+            }
+        }
+        double map_ns = Elapsed(start, count);
+        start = chrono::steady_clock::now();
+        for(int i = 0; i < count; ++i){
+            short id = sequence[i & 0xffff];
+            auto iter = hashed.find(id);
+            if(iter != hashed.end()){
+                iter->second(hashed_ctx, id, body, length);
+            }
+        }
+        double hashed_ns = Elapsed(start, count);
+        printf("%s ids: static table %.2f ns, map+function %.2f ns, unordered_map+function %.2f ns%s\n",
+            mode == 0 ? "random" : "same", table_ns, map_ns, hashed_ns,
+            table_ctx.sum == map_ctx.sum && map_ctx.sum == hashed_ctx.sum ? "" : " (MISMATCH)");
+    }
+    return 0;
+}
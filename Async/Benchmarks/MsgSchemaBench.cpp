@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "../Common/Messages.h"
+#include "Position.pb.h"
+
+using namespace std;
+
+// MsgSchema 微基准：PositionMsg 用 EncodeMsg / DecodeMsg 编解码，对比 protoc 为同样字段生成的 Position
+// （SerializeToArray / ParseFromArray，name 按 15 字节发送）。每次循环改一个字段，避免被编译器提到循环外。
+// 仓库本身不依赖 Protobuf，编译前先用 protoc 生成 Position.pb.h/.cc，见 README.md。
+// 用法：MsgSchemaBench [次数]
+
+namespace{
+
+volatile uint64_t sink;
+
+double Elapsed(chrono::steady_clock::time_point start, int count){
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int count = argc > 1 ? atoi(argv[1]) : 5000000;
+    PositionMsg msg;
+    msg.entity_id = 123456789012ULL;
+    msg.seq = 77;
+    msg.x = 1.5f;
+    msg.y = -2.25f;
+    msg.z = 1000.125f;
+    msg.yaw = -9000;
+    msg.state = 3;
+    memcpy(msg.name.data(), "player_one", 10);
+
+    Position proto;
+    proto.set_entity_id(msg.entity_id);
+    proto.set_seq(msg.seq);
+    proto.set_x(msg.x);
+    proto.set_y(msg.y);
+    proto.set_z(msg.z);
+    proto.set_yaw(msg.yaw);
+    proto.set_state(msg.state);
+    proto.set_name(string(msg.name.data(), msg.name.size()));
+
+    char buffer[128];
+    auto start = chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i){
+        msg.seq = i;
+        EncodeMsg(msg, buffer);
+        sink = sink + buffer[10];
+    }
+    double schema_encode = Elapsed(start, count);
+    PositionMsg decoded;
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i){
+        buffer[11] = static_cast<char>(i);
+        DecodeMsg(buffer, MsgWireSize<PositionMsg>, decoded);
+        sink = sink + decoded.seq;
+    }
+    double schema_decode = Elapsed(start, count);
+
+    int proto_size = 0;
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i){
+        proto.set_seq(i);
+        proto_size = static_cast<int>(proto.ByteSizeLong());
+        proto.SerializeToArray(buffer, proto_size);
+        sink = sink + buffer[10];
+    }
+    double proto_encode = Elapsed(start, count);
+    Position parsed;
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i){
+        parsed.ParseFromArray(buffer, proto_size);
+        sink = sink + parsed.seq();
+    }
+    double proto_decode = Elapsed(start, count);
+
+    printf("size: MsgSchema %zu B, protobuf %d B\n", MsgWireSize<PositionMsg>, proto_size);
+    printf("MsgSchema: encode %.1f ns, decode %.1f ns\n", schema_encode, schema_decode);
+    printf("protobuf:  encode %.1f ns, decode %.1f ns\n", proto_encode, proto_decode);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../Common/MsgHeader.h"
+
+using namespace std;
+
+// 接收路径的拷贝量模拟：不收发数据，只按两种接收方式的规则统计每帧搬动的字节数（拷贝 + 清零）。
+// 1. 原来的做法：每次 async_read_some 之前 memset 整个 MAX_LENGTH 缓冲区，收到的每个字节再拷贝到头部/消息体节点
+// 2. 原地解析（Session::StartRead / HandleRead）：帧在接收缓冲区中原地交给 HandleMsg，
+//    只有尾部空间放不下下一帧时才把没解析完的残留数据 memmove 到开头，大帧时扩容
+// 消息体长度按指数分布（原来的做法只支持不超过 MAX_LENGTH 的帧，这里只统计拷贝量），
+// 每次读取得到的字节数在 [1, 可读空间] 内均匀随机，模拟任意的 TCP 分段。
+// 用法：RecvBufferSim [帧数]
+
+namespace{
+
+// 原来 Session_demo.cpp 中的 MAX_LENGTH（1024*2）
+const size_t OLD_MAX_LENGTH = 2048;
+// 与 v2_FullDuplex/Session_demo.h 保持一致
+const size_t RECV_BUFFER_SIZE = 16 * 1024;
+const size_t MIN_READ_SIZE = 4 * 1024;
+
+struct Result{
+    double old_bytes;
+    double new_bytes;
+};
+
+Result Simulate(int frames, double mean_payload, mt19937& rng){
+    exponential_distribution<double> payload(1.0 / mean_payload);
+    vector<size_t> frame_len(frames);
+    size_t total = 0;
+    for(auto& len : frame_len){
+        len = MSG_HEAD_LENGTH + min<size_t>(static_cast<size_t>(payload(rng)), 64 * 1024);
+        total += len;
+    }
+
+    // 原来的做法：每次最多读 MAX_LENGTH，每次读之前清零整个缓冲区，每个字节拷贝一次
+    uint64_t old_bytes = 0;
+    for(size_t received = 0; received < total;){
+        size_t n = uniform_int_distribution<size_t>(1, min(OLD_MAX_LENGTH, total - received))(rng);
+        old_bytes += OLD_MAX_LENGTH + n;
+        received += n;
+    }
+
+    // 原地解析：按 StartRead 的规则决定是否搬移、扩容
+    uint64_t new_bytes = 0;
+    size_t buffer_size = RECV_BUFFER_SIZE, begin = 0, end = 0, need = MSG_HEAD_LENGTH;
+    size_t next_frame = 0, frame_start = 0;
+    for(size_t received = 0; received < total;){
+        size_t remain = end - begin;
+        size_t want = max(need, remain + MIN_READ_SIZE);
+        if(begin + want > buffer_size){
+            if(begin > 0){
+                new_bytes += remain;
+                begin = 0;
+                end = remain;
+            }
+            if(want > buffer_size){
+                // vector::resize 搬动已有的内容
+                new_bytes += end;
+                buffer_size = want;
+            }
+        }
+        size_t n = uniform_int_distribution<size_t>(1, min(buffer_size - end, total - received))(rng);
+        end += n;
+        received += n;
+        // 解析出所有完整的帧，不拷贝
+        need = MSG_HEAD_LENGTH;
+        while(next_frame < frame_len.size()){
+            size_t len = frame_len[next_frame];
+            if(received < frame_start + len){
+                if(end - begin >= MSG_HEAD_LENGTH){
+                    need = len;
+                }
+                break;
+            }
+            begin += len;
+            frame_start += len;
+            ++next_frame;
+        }
+        if(begin == end){
+            begin = 0;
+            end = 0;
+        }
+    }
+    return {double(old_bytes) / frames, double(new_bytes) / frames};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int frames = argc > 1 ? atoi(argv[1]) : 100000;
+    mt19937 rng(1);
+    printf("bytes copied or zeroed per frame, %d frames\n", frames);
+    for(double mean : {16.0, 200.0, 1400.0}){
+        Result r = Simulate(frames, mean, rng);
+        printf("avg payload %6.0f B: old %8.1f B, in place %7.1f B\n", mean, r.old_bytes, r.new_bytes);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include "../v2_FullDuplex/AsioIOServicePool.h"
+#include "../v2_FullDuplex/Server_demo.h"
+#include "../v2_FullDuplex/SessionRegistry.h"
+#include "../v2_FullDuplex/Session_demo.h"
+
+using namespace std;
+
+// SessionRegistry 微基准：10 万个会话，T 个线程各自对自己负责的会话反复 erase + insert，再 find 一个其他会话，
+// 对比原来以 UUID 字符串为键、一把全局锁保护的 std::map。每个操作单独加一次锁，与 accept / 断开时的调用方式一致。
+// 会话只构造不启动（需要一个 Server 提供时间轮，监听端口为 0、管理端口关闭）。
+// 用法：SessionRegistryBench [线程数]
+
+namespace{
+
+const int SESSIONS = 100000;
+const int ROUNDS = 10;
+
+template <typename Body>
+double RunThreads(int threads, Body body){
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for(int t = 0; t < threads; ++t){
+        workers.emplace_back([&, t](){
+            for(int round = 0; round < ROUNDS; ++round){
+                for(int i = t; i < SESSIONS; i += threads){
+                    body(i);
+                }
+            }
+        });
+    }
+    for(auto& worker : workers){
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    // 每次循环 3 个操作
+    return 3.0 * SESSIONS * ROUNDS / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int threads = argc > 1 ? atoi(argv[1]) : 1;
+    boost::asio::io_context ioc;
+    AsioIOServicePool pool(1);
+    ServerConfig config;
+    config.port = 0;
+    config.admin_port = 0;
+    Server server(ioc, pool, config);
+
+    vector<shared_ptr<Session>> sessions;
+    sessions.reserve(SESSIONS);
+    for(int i = 0; i < SESSIONS; ++i){
+        sessions.push_back(make_shared<Session>(pool.GetIOService(0), &server, i + 1, 0));
+    }
+
+    {
+        // 与原来一样用随机 UUID 文本作键，预先生成好，只比较查表本身
+        boost::uuids::random_generator generator;
+        vector<string> uuids;
+        map<string, shared_ptr<Session>> sessions_map;
+        mutex lock;
+        for(auto& session : sessions){
+            uuids.push_back(boost::uuids::to_string(generator()));
+            sessions_map.emplace(uuids.back(), session);
+        }
+        double mops = RunThreads(threads, [&](int i){
+            {
+                lock_guard<mutex> guard(lock);
+                sessions_map.erase(uuids[i]);
+            }
+            {
+                lock_guard<mutex> guard(lock);
+                sessions_map.emplace(uuids[i], sessions[i]);
+            }
+            lock_guard<mutex> guard(lock);
+            volatile bool found = sessions_map.find(uuids[(i * 7) % SESSIONS]) != sessions_map.end();
+            (void)found;
+        });
+        printf("map<string>+mutex  %d threads: %.2f Mops/s\n", threads, mops);
+    }
+
+    {
+        SessionRegistry registry;
+        for(auto& session : sessions){
+            registry.Insert(session);
+        }
+        double mops = RunThreads(threads, [&](int i){
+            auto& session = sessions[i];
+            registry.Erase(session->GetSessionId());
+            registry.Insert(session);
+            volatile bool found = static_cast<bool>(registry.Find(sessions[(i * 7) % SESSIONS]->GetSessionId()));
+            (void)found;
+        });
+        printf("SessionRegistry    %d threads: %.2f Mops/s\n", threads, mops);
+
+        auto start = chrono::steady_clock::now();
+        size_t count = 0;
+        registry.ForEach([&](const shared_ptr<Session>&){
+            ++count;
+        });
+        printf("ForEach over %zu sessions: %.2f ms\n", count,
+            chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+    pool.Stop();
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "AdminServer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <string>
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+struct AdminServer::Connection{
+    explicit Connection(boost::asio::io_context& ioc)
+        :socket(ioc), request(MAX_REQUEST_SIZE){
+    }
+    // 请求头上限，超过则直接关闭
+    enum{MAX_REQUEST_SIZE = 8 * 1024};
+    tcp::socket socket;
+    boost::asio::streambuf request;
+    string response;
+};
+
+AdminServer::AdminServer(boost::asio::io_context& ioc, unsigned short port)
+    :_ioc(ioc), _acceptor(ioc), _retry_timer(ioc){
+    //逐步打开监听，失败时不抛异常：管理端口不可用不应妨碍服务器启动
+    tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+    boost::system::error_code ec;
+    _acceptor.open(endpoint.protocol(), ec);
+    if(!ec){
+        _acceptor.set_option(tcp::acceptor::reuse_address(true), ec);
+        _acceptor.bind(endpoint, ec);
+    }
+    if(!ec){
+        _acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+    }
+    if(ec){
+        LOG_WARN("Admin endpoint disabled, cannot listen on 127.0.0.1:", port, ": ", ec.message());
+        boost::system::error_code ignored;
+        _acceptor.close(ignored);
+        return;
+    }
+    LOG_INFO("Admin endpoint on 127.0.0.1:", port, " (/metrics, /metrics.json)");
+    StartAccept();
+}
+
+void AdminServer::Stop(){
+    boost::system::error_code ec;
+    _acceptor.close(ec);
+    _retry_timer.cancel();
+}
+
+void AdminServer::StartAccept(){
+    auto connection = make_shared<Connection>(_ioc);
+    _acceptor.async_accept(connection->socket, [this, connection](const boost::system::error_code& error){
+        if(error == boost::asio::error::operation_aborted || !_acceptor.is_open()){
+            return;
+        }
+        if(error){
+            RetryAccept(error);
+            return;
+        }
+        _retry_delay = std::chrono::milliseconds(MIN_RETRY_MS);
+        boost::asio::async_read_until(connection->socket, connection->request, "\r\n\r\n",
+            [this, connection](const boost::system::error_code& error, size_t /*bytes*/){
+                if(!error){
+                    HandleRequest(connection);
+                }
+            });
+        StartAccept();
+    });
+}
+
+void AdminServer::RetryAccept(const boost::system::error_code& error){
+    //EMFILE / ENFILE / ENOBUFS 等错误在条件解除前会立即重复出现，马上重试只会空转
+    LOG_WARN("Admin accept failed: ", error.message(), ", retrying in ", _retry_delay.count(), " ms");
+    _retry_timer.expires_after(_retry_delay);
+    _retry_delay = std::min(_retry_delay * 2, std::chrono::milliseconds(MAX_RETRY_MS));
+    _retry_timer.async_wait([this](const boost::system::error_code& error){
+        if(!error && _acceptor.is_open()){
+            StartAccept();
+        }
+    });
+}
+
+void AdminServer::HandleRequest(const shared_ptr<Connection>& connection){
+    //只看请求行：METHOD PATH VERSION
+    istream stream(&connection->request);
+    string method, path;
+    stream >> method >> path;
+
+    string status = "200 OK";
+    string content_type;
+    string body;
+    if(method != "GET"){
+        status = "405 Method Not Allowed";
+    }else if(path == "/metrics"){
+        content_type = "text/plain; version=0.0.4";
+        body = Metrics::ToPrometheus(Metrics::Collect());
+    }else if(path == "/metrics.json"){
+        content_type = "application/json";
+        body = Metrics::ToJson(Metrics::Collect());
+    }else{
+        status = "404 Not Found";
+    }
+    if(content_type.empty()){
+        content_type = "text/plain";
+        body = status + "\n";
+    }
+
+    connection->response = "HTTP/1.0 " + status + "\r\nContent-Type: " + content_type
+        + "\r\nContent-Length: " + to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    boost::asio::async_write(connection->socket, boost::asio::buffer(connection->response),
+        [connection](const boost::system::error_code& /*error*/, size_t /*bytes*/){
+            boost::system::error_code ec;
+            connection->socket.shutdown(tcp::socket::shutdown_both, ec);
+            connection->socket.close(ec);
+        });
+}
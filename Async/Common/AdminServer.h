@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <boost/asio.hpp>
+
+// AdminServer: 本地管理端口，以 HTTP 提供指标
+// 只监听 127.0.0.1，与业务端口分开；每个请求一个短连接，处理完即关闭。
+//   GET /metrics       Prometheus 文本格式
+//   GET /metrics.json  JSON
+// 运行在传入的 io_context 上（一般是只负责 accept 的主 io_context），不占用 IO 线程。
+// 管理端口不影响业务：端口被占用等原因监听失败时只打印警告，IsOpen() 返回 false；
+// accept 出错（如 EMFILE）时按指数退避重试，不会空转。
+class AdminServer{
+public:
+    AdminServer(boost::asio::io_context& ioc, unsigned short port);
+
+    // 是否在监听
+    bool IsOpen() const{
+        return _acceptor.is_open();
+    }
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    // 停止接受新的请求
+    void Stop();
+
+private:
+    struct Connection;
+    void StartAccept();
+    // accept 出错后等待 _retry_delay 再重试，每次连续出错翻倍
+    void RetryAccept(const boost::system::error_code& error);
+    void HandleRequest(const std::shared_ptr<Connection>& connection);
+
+    // 重试等待的初始值和上限
+    enum{MIN_RETRY_MS = 100, MAX_RETRY_MS = 5000};
+
+    boost::asio::io_context& _ioc;
+    boost::asio::ip::tcp::acceptor _acceptor;
+    boost::asio::steady_timer _retry_timer;
+    std::chrono::milliseconds _retry_delay{MIN_RETRY_MS};
+};
@@ -0,0 +1,209 @@
+#include "BufferPool.h"
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace{
+
+// 空闲块复用自身内存（从块头开始）存放 next 指针
+struct FreeBlock{
+    FreeBlock* next;
+};
+
+struct ThreadCache;
+
+// 已分配块的块头：记录分配它的线程缓存，释放时据此决定放回本地链表还是远程释放栈
+struct alignas(alignof(std::max_align_t)) BlockHeader{
+    ThreadCache* owner;
+};
+static_assert(sizeof(BlockHeader) == BufferPool::BLOCK_HEADER_SIZE, "BLOCK_HEADER_SIZE must match BlockHeader");
+
+// 远程释放栈的关闭标记：所属线程已退出，压入方直接把块还给系统
+FreeBlock* const CLOSED = reinterpret_cast<FreeBlock*>(1);
+
+// 每个线程一份：本地链表只有所属线程读写；远程释放栈由其他线程压入、所属线程整条取走
+struct ThreadCache{
+    FreeBlock* heads[BufferPool::CLASS_COUNT] = {};
+    std::size_t counts[BufferPool::CLASS_COUNT] = {};
+    // 仅由所属线程递增，用 relaxed 读写避免 lock 前缀
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> remote_frees{0};
+    // 其他线程频繁写入，单独占一个缓存行，不和本地链表伪共享
+    alignas(64) std::atomic<FreeBlock*> remote_heads[BufferPool::CLASS_COUNT] = {};
+
+    void Count(std::atomic<std::uint64_t>& counter){
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// 所有线程缓存的登记表。线程退出后缓存不释放而是留给新线程复用：
+// 其他线程可能仍持有该缓存分配的块，释放时还要访问它的远程释放栈
+struct CacheRegistry{
+    std::mutex lock;
+    std::vector<ThreadCache*> caches;
+    std::vector<ThreadCache*> idle;
+};
+
+CacheRegistry& Registry(){
+    static CacheRegistry* registry = new CacheRegistry(); // 故意不析构，线程退出可能晚于静态对象析构
+    return *registry;
+}
+
+void FreeList(FreeBlock* block){
+    while(block != nullptr){
+        FreeBlock* next = block->next;
+        ::operator delete(block);
+        block = next;
+    }
+}
+
+// 线程首次使用内存池时取一个缓存，退出时清空并交回登记表
+struct CacheHandle{
+    ThreadCache* cache;
+
+    CacheHandle(){
+        auto& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.lock);
+        if(!registry.idle.empty()){
+            cache = registry.idle.back();
+            registry.idle.pop_back();
+            // 重新打开远程释放栈；旧线程分配、尚未释放的块此后归还给本线程
+            for(auto& head : cache->remote_heads){
+                head.store(nullptr, std::memory_order_release);
+            }
+        }
+        else{
+            cache = new ThreadCache();
+            registry.caches.push_back(cache);
+        }
+    }
+
+    ~CacheHandle(){
+        for(int i = 0; i < BufferPool::CLASS_COUNT; ++i){
+            FreeList(cache->heads[i]);
+            cache->heads[i] = nullptr;
+            cache->counts[i] = 0;
+            // 关闭后其他线程不再压入，之后释放的块直接还给系统
+            FreeList(cache->remote_heads[i].exchange(CLOSED, std::memory_order_acquire));
+        }
+        auto& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.lock);
+        registry.idle.push_back(cache);
+    }
+};
+
+thread_local CacheHandle t_handle;
+
+// 返回 size（含块头）所属的级别，超过最大级别返回 -1
+int ClassIndex(std::size_t size){
+    std::size_t block = std::size_t(1) << BufferPool::MIN_CLASS_SHIFT;
+    for(int i = 0; i < BufferPool::CLASS_COUNT; ++i, block <<= 1){
+        if(size <= block){
+            return i;
+        }
+    }
+    return -1;
+}
+
+std::size_t ClassSize(int index){
+    return std::size_t(1) << (BufferPool::MIN_CLASS_SHIFT + index);
+}
+
+// 本地链表为空时整条取走远程释放栈。不受缓存上限约束：这些块都由本线程分配，
+// 数量不超过本线程同时在途的块数，截断只会让下一轮分配重新向系统申请
+FreeBlock* TakeRemote(ThreadCache& cache, int index){
+    if(cache.remote_heads[index].load(std::memory_order_relaxed) == nullptr){
+        return nullptr;
+    }
+    FreeBlock* list = cache.remote_heads[index].exchange(nullptr, std::memory_order_acquire);
+    std::size_t count = 0;
+    for(FreeBlock* block = list; block != nullptr; block = block->next){
+        ++count;
+    }
+    cache.counts[index] = count;
+    return list;
+}
+
+void* Publish(void* raw, ThreadCache* owner){
+    static_cast<BlockHeader*>(raw)->owner = owner;
+    return static_cast<char*>(raw) + BufferPool::BLOCK_HEADER_SIZE;
+}
+
+} // namespace
+
+void* BufferPool::Allocate(std::size_t size){
+    ThreadCache& cache = *t_handle.cache;
+    int index = ClassIndex(size + BLOCK_HEADER_SIZE);
+    if(index < 0){
+        cache.Count(cache.misses);
+        return ::operator new(size);
+    }
+
+    FreeBlock* block = cache.heads[index];
+    if(block == nullptr){
+        block = TakeRemote(cache, index);
+    }
+    if(block != nullptr){
+        cache.heads[index] = block->next;
+        --cache.counts[index];
+        cache.Count(cache.hits);
+        return Publish(block, &cache);
+    }
+
+    cache.Count(cache.misses);
+    return Publish(::operator new(ClassSize(index)), &cache);
+}
+
+void BufferPool::Deallocate(void* ptr, std::size_t size){
+    if(ptr == nullptr){
+        return;
+    }
+    int index = ClassIndex(size + BLOCK_HEADER_SIZE);
+    // 超大块没有块头，直接归还系统
+    if(index < 0){
+        ::operator delete(ptr);
+        return;
+    }
+
+    void* raw = static_cast<char*>(ptr) - BLOCK_HEADER_SIZE;
+    ThreadCache* owner = static_cast<BlockHeader*>(raw)->owner;
+    FreeBlock* block = static_cast<FreeBlock*>(raw);
+    ThreadCache& cache = *t_handle.cache;
+    if(owner == &cache){
+        // 缓存已满，直接归还系统
+        if(cache.counts[index] >= MAX_CACHED_BLOCKS){
+            ::operator delete(raw);
+            return;
+        }
+        block->next = cache.heads[index];
+        cache.heads[index] = block;
+        ++cache.counts[index];
+        return;
+    }
+
+    // 其他线程分配的块：压入所属线程的远程释放栈，所属线程已退出时直接归还系统
+    cache.Count(cache.remote_frees);
+    std::atomic<FreeBlock*>& head = owner->remote_heads[index];
+    FreeBlock* expected = head.load(std::memory_order_relaxed);
+    do{
+        if(expected == CLOSED){
+            ::operator delete(raw);
+            return;
+        }
+        block->next = expected;
+    }while(!head.compare_exchange_weak(expected, block, std::memory_order_release, std::memory_order_relaxed));
+}
+
+BufferPool::Stats BufferPool::GetStats(){
+    Stats stats;
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    for(ThreadCache* cache : registry.caches){
+        stats.hits += cache->hits.load(std::memory_order_relaxed);
+        stats.misses += cache->misses.load(std::memory_order_relaxed);
+        stats.remote_frees += cache->remote_frees.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// BufferPool: 按大小分级的线程本地内存池
+// 设计原理：
+// 1. 把请求大小（加上 16 字节块头）向上取整到 64B ~ 64KB 的若干级别，每个级别在每个线程上维护一条空闲链表。
+// 2. 分配时优先从当前线程的空闲链表取（命中），为空才调用 operator new（未命中）。块头记录分配它的线程缓存。
+// 3. 在分配线程上释放时放回该线程的空闲链表，不需要加锁；链表长度有上限，超出的直接归还给系统。
+// 4. 在其他线程上释放（例如 IO 线程分配、逻辑线程释放的消息节点）时，用一次 CAS 压入所属线程的远程释放栈，
+//    所属线程的空闲链表为空时一次取走整条栈。块总是回到分配它的线程，生产者与消费者分属两个线程时也能循环复用。
+// 5. 超过最大级别的请求直接走 operator new/delete，同样计为未命中。
+class BufferPool{
+public:
+    // 分配至少 size 字节，释放时必须传入相同的 size
+    static void* Allocate(std::size_t size);
+    static void Deallocate(void* ptr, std::size_t size);
+
+    // 命中/未命中计数，汇总所有线程（包括已退出的线程）
+    struct Stats{
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t remote_frees = 0; // 在非分配线程上释放、经远程释放栈归还的块数
+    };
+    static Stats GetStats();
+
+    // 级别划分：64B << i，共 CLASS_COUNT 级，最大 64KB（含块头）
+    enum{MIN_CLASS_SHIFT = 6, CLASS_COUNT = 11};
+    // 每块前面记录所属线程缓存的块头大小，保持 max_align_t 对齐
+    enum{BLOCK_HEADER_SIZE = 16};
+    // 每级空闲链表最多缓存的块数
+    enum{MAX_CACHED_BLOCKS = 256};
+};
+
+// PoolAllocator: 标准分配器适配，供 shared_ptr 控制块等从 BufferPool 分配
+template <typename T>
+class PoolAllocator{
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept{}
+
+    T* allocate(std::size_t n){
+        return static_cast<T*>(BufferPool::Allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, std::size_t n) noexcept{
+        BufferPool::Deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept{ return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept{ return false; }
+};
+
+// PoolHandler: 给 Asio 的完成处理函数关联 PoolAllocator，Asio 为这次异步操作分配的内部对象
+// （async_write 的中间状态、投递到其他线程的 dispatch 任务等）也从 BufferPool 分配
+// Boost 1.79 起可以用 boost::asio::bind_allocator 代替
+template <typename Handler>
+class PoolHandler{
+public:
+    using allocator_type = PoolAllocator<void>;
+
+    explicit PoolHandler(Handler handler):_handler(std::move(handler)){}
+
+    allocator_type get_allocator() const noexcept{
+        return allocator_type();
+    }
+
+    template <typename... Args>
+    void operator()(Args&&... args){
+        _handler(std::forward<Args>(args)...);
+    }
+
+private:
+    Handler _handler;
+};
+
+template <typename Handler>
+PoolHandler<Handler> BindPool(Handler handler){
+    return PoolHandler<Handler>(std::move(handler));
+}
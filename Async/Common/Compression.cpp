@@ -0,0 +1,193 @@
+#include "Compression.h"
+#include <cstring>
+#include <limits>
+#ifdef ASYNC_HAS_LZ4
+#include <lz4.h>
+#endif
+#ifdef ASYNC_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+namespace{
+
+// zlib 使用最快的压缩级别：帧在收发路径上同步压缩，延迟比压缩率更重要
+constexpr int ZLIB_LEVEL = 1;
+
+#ifdef ASYNC_HAS_ZLIB
+// 每个线程复用一对 zlib 流：compress2 / uncompress 每次调用都要分配并清零约 256KB 的状态，
+// 对几 KB 的帧来说比压缩本身还慢；deflateReset / inflateReset 只重置状态，不重新分配
+class ZlibStreams{
+public:
+    ZlibStreams(){
+        std::memset(&_deflate, 0, sizeof(_deflate));
+        std::memset(&_inflate, 0, sizeof(_inflate));
+        _deflate_ok = deflateInit(&_deflate, ZLIB_LEVEL) == Z_OK;
+        _inflate_ok = inflateInit(&_inflate) == Z_OK;
+    }
+    ~ZlibStreams(){
+        if(_deflate_ok){
+            deflateEnd(&_deflate);
+        }
+        if(_inflate_ok){
+            inflateEnd(&_inflate);
+        }
+    }
+    ZlibStreams(const ZlibStreams&) = delete;
+    ZlibStreams& operator=(const ZlibStreams&) = delete;
+
+    // 压缩到 out（容量 capacity），输出放不下时失败；成功时 written 为压缩后的长度
+    bool Deflate(const char* in, std::size_t length, char* out, std::size_t capacity, std::size_t& written){
+        if(!_deflate_ok || deflateReset(&_deflate) != Z_OK){
+            return false;
+        }
+        _deflate.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+        _deflate.avail_in = static_cast<uInt>(length);
+        _deflate.next_out = reinterpret_cast<Bytef*>(out);
+        _deflate.avail_out = static_cast<uInt>(capacity);
+        if(deflate(&_deflate, Z_FINISH) != Z_STREAM_END){
+            return false;
+        }
+        written = capacity - _deflate.avail_out;
+        return true;
+    }
+
+    // 解压到 out，结果必须恰好为 length 字节且输入恰好用完
+    bool Inflate(const char* in, std::size_t size, char* out, std::size_t length){
+        if(!_inflate_ok || inflateReset(&_inflate) != Z_OK){
+            return false;
+        }
+        _inflate.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+        _inflate.avail_in = static_cast<uInt>(size);
+        _inflate.next_out = reinterpret_cast<Bytef*>(out);
+        _inflate.avail_out = static_cast<uInt>(length);
+        return inflate(&_inflate, Z_FINISH) == Z_STREAM_END && _inflate.avail_out == 0 && _inflate.avail_in == 0;
+    }
+
+private:
+    z_stream _deflate;
+    z_stream _inflate;
+    bool _deflate_ok = false;
+    bool _inflate_ok = false;
+};
+
+ZlibStreams& LocalZlibStreams(){
+    thread_local ZlibStreams streams;
+    return streams;
+}
+#endif
+
+void WriteLength(char* out, std::uint32_t length){
+    unsigned char* p = reinterpret_cast<unsigned char*>(out);
+    p[0] = static_cast<unsigned char>(length >> 24);
+    p[1] = static_cast<unsigned char>(length >> 16);
+    p[2] = static_cast<unsigned char>(length >> 8);
+    p[3] = static_cast<unsigned char>(length);
+}
+
+} // namespace
+
+std::uint8_t Compression::SupportedCodecs(){
+    std::uint8_t codecs = 0;
+#ifdef ASYNC_HAS_LZ4
+    codecs |= MSG_FLAG_LZ4;
+#endif
+#ifdef ASYNC_HAS_ZLIB
+    codecs |= MSG_FLAG_ZLIB;
+#endif
+    return codecs;
+}
+
+std::uint8_t Compression::Negotiate(std::uint8_t local, std::uint8_t remote){
+    std::uint8_t common = local & remote & SupportedCodecs();
+    if(common & MSG_FLAG_LZ4){
+        return MSG_FLAG_LZ4;
+    }
+    if(common & MSG_FLAG_ZLIB){
+        return MSG_FLAG_ZLIB;
+    }
+    return 0;
+}
+
+bool Compression::Compress(std::uint8_t codec, [[maybe_unused]] const char* data, std::size_t length, std::vector<char>& out){
+    if(length <= PREFIX_LENGTH || length > std::numeric_limits<std::uint32_t>::max()){
+        return false;
+    }
+    //压缩结果至少要比原始数据小，否则按原样发送，输出缓冲区按此上限准备即可
+    std::size_t limit = length - PREFIX_LENGTH;
+    std::size_t compressed = 0;
+    switch(codec){
+#ifdef ASYNC_HAS_LZ4
+    case MSG_FLAG_LZ4:{
+        if(length > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)){
+            return false;
+        }
+        out.resize(PREFIX_LENGTH + limit);
+        //输出空间不足时返回 0，即压缩后没有变小
+        int n = LZ4_compress_default(data, out.data() + PREFIX_LENGTH, static_cast<int>(length), static_cast<int>(limit));
+        if(n <= 0){
+            return false;
+        }
+        compressed = static_cast<std::size_t>(n);
+        break;
+    }
+#endif
+#ifdef ASYNC_HAS_ZLIB
+    case MSG_FLAG_ZLIB:{
+        if(length > std::numeric_limits<uInt>::max()){
+            return false;
+        }
+        out.resize(PREFIX_LENGTH + limit);
+        //输出空间不足时 deflate 无法结束，即压缩后没有变小
+        if(!LocalZlibStreams().Deflate(data, length, out.data() + PREFIX_LENGTH, limit, compressed)){
+            return false;
+        }
+        break;
+    }
+#endif
+    default:
+        return false;
+    }
+    if(compressed >= limit){
+        return false;
+    }
+    WriteLength(out.data(), static_cast<std::uint32_t>(length));
+    out.resize(PREFIX_LENGTH + compressed);
+    return true;
+}
+
+bool Compression::OriginalLength(const char* body, std::size_t length, std::uint32_t& original){
+    if(length < PREFIX_LENGTH){
+        return false;
+    }
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(body);
+    original = (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16)
+        | (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+    return true;
+}
+
+bool Compression::Decompress(std::uint8_t codec, const char* body, std::size_t length, [[maybe_unused]] char* out,
+    [[maybe_unused]] std::uint32_t original){
+    if(length < PREFIX_LENGTH){
+        return false;
+    }
+    [[maybe_unused]] const char* data = body + PREFIX_LENGTH;
+    [[maybe_unused]] std::size_t size = length - PREFIX_LENGTH;
+    switch(codec){
+#ifdef ASYNC_HAS_LZ4
+    case MSG_FLAG_LZ4:{
+        //safe 版本会检查输入越界，恶意数据不会写出 out 的范围
+        int n = LZ4_decompress_safe(data, out, static_cast<int>(size), static_cast<int>(original));
+        return n >= 0 && static_cast<std::uint32_t>(n) == original;
+    }
+#endif
+#ifdef ASYNC_HAS_ZLIB
+    case MSG_FLAG_ZLIB:{
+        return size <= std::numeric_limits<uInt>::max() && LocalZlibStreams().Inflate(data, size, out, original);
+    }
+#endif
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MsgHeader.h"
+
+// 编译期开关：有对应头文件时启用，链接时分别需要 -llz4 / -lz；
+// 编译时加 -DASYNC_DISABLE_LZ4 / -DASYNC_DISABLE_ZLIB 可去掉对应算法
+#if __has_include(<lz4.h>) && !defined(ASYNC_DISABLE_LZ4)
+#define ASYNC_HAS_LZ4 1
+#endif
+#if __has_include(<zlib.h>) && !defined(ASYNC_DISABLE_ZLIB)
+#define ASYNC_HAS_ZLIB 1
+#endif
+
+// Compression: 单帧压缩
+// 压缩帧的消息体：
+// +----------------------+------------------------+
+// | original length (4)  |    compressed data     |
+// +----------------------+------------------------+
+// 1. 每帧独立压缩，不保留跨帧的字典状态，丢弃或重排帧都不影响解压。
+// 2. 只压缩不小于阈值的帧；压缩后没有变小时按原样发送，小帧不增加任何延迟。
+// 3. 原始长度写在最前面，接收方先按它检查帧长度上限，再从内存池分配恰好大小的缓冲区解压。
+// 4. codec 取值为 MSG_FLAG_LZ4 或 MSG_FLAG_ZLIB，与帧头 flags 中的压缩位相同。
+class Compression{
+public:
+    // 压缩帧消息体中原始长度字段的字节数
+    enum{PREFIX_LENGTH = 4};
+
+    // 本次编译支持的算法（MSG_FLAG_LZ4 / MSG_FLAG_ZLIB 的组合）
+    static std::uint8_t SupportedCodecs();
+    // 从双方都支持的算法中选一个，LZ4 优先（速度快得多）；没有共同算法时返回 0
+    static std::uint8_t Negotiate(std::uint8_t local, std::uint8_t remote);
+
+    // 把 data 压缩成压缩帧的消息体，写入 out（会按需扩容，可反复复用）
+    // 压缩后不比原始数据小、算法不支持或失败时返回 false，调用方应按原样发送
+    static bool Compress(std::uint8_t codec, const char* data, std::size_t length, std::vector<char>& out);
+    // 读取压缩帧消息体中的原始长度，消息体不足 PREFIX_LENGTH 字节时返回 false
+    static bool OriginalLength(const char* body, std::size_t length, std::uint32_t& original);
+    // 把压缩帧的消息体解压到 out（容量为 original 字节），解压结果长度必须恰好为 original
+    static bool Decompress(std::uint8_t codec, const char* body, std::size_t length, char* out, std::uint32_t original);
+};
@@ -0,0 +1,283 @@
+#include "IoUring.h"
+#include "Logger.h"
+
+#ifdef ASYNC_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace{
+
+template <typename T>
+T* Offset(void* base, std::uint32_t offset){
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+void* Map(int fd, std::size_t size, off_t offset){
+    void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+} // namespace
+
+IoUring::IoUring(boost::asio::io_context& ioc, unsigned entries):_ioc(ioc), _event(ioc){
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    // 完成队列放大一倍：每个会话最多一个读和一个写在途
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2;
+    _ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if(_ring_fd < 0){
+        LOG_WARN("io_uring_setup failed: ", std::strerror(errno));
+        return;
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if(single_mmap){
+        _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+    }
+    _sq_ring = Map(_ring_fd, _sq_ring_size, IORING_OFF_SQ_RING);
+    _cq_ring = single_mmap ? _sq_ring : Map(_ring_fd, _cq_ring_size, IORING_OFF_CQ_RING);
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = Map(_ring_fd, _sqes_size, IORING_OFF_SQES);
+    if(_sq_ring == nullptr || _cq_ring == nullptr || _sqes == nullptr){
+        LOG_WARN("io_uring mmap failed: ", std::strerror(errno));
+        Release();
+        return;
+    }
+
+    _sq_head = Offset<unsigned>(_sq_ring, params.sq_off.head);
+    _sq_tail = Offset<unsigned>(_sq_ring, params.sq_off.tail);
+    _sq_flags = Offset<unsigned>(_sq_ring, params.sq_off.flags);
+    _sq_mask = *Offset<unsigned>(_sq_ring, params.sq_off.ring_mask);
+    _sq_entries = *Offset<unsigned>(_sq_ring, params.sq_off.ring_entries);
+    _sq_local_tail = *_sq_tail;
+    // SQ 的间接数组固定为恒等映射，第 i 个槽位就是 sqes[i]
+    unsigned* array = Offset<unsigned>(_sq_ring, params.sq_off.array);
+    for(unsigned i = 0; i < _sq_entries; ++i){
+        array[i] = i;
+    }
+    _cq_head = Offset<unsigned>(_cq_ring, params.cq_off.head);
+    _cq_tail = Offset<unsigned>(_cq_ring, params.cq_off.tail);
+    _cq_mask = *Offset<unsigned>(_cq_ring, params.cq_off.ring_mask);
+    _cqes = Offset<void>(_cq_ring, params.cq_off.cqes);
+
+    // 完成时通知 eventfd，由 io_context 的 reactor 监听
+    _event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(_event_fd < 0 || ::syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_EVENTFD, &_event_fd, 1) < 0){
+        LOG_WARN("io_uring eventfd registration failed: ", std::strerror(errno));
+        Release();
+        return;
+    }
+    _event.assign(_event_fd);
+}
+
+IoUring::~IoUring(){
+    Release();
+}
+
+void IoUring::Release(){
+    // 在途操作的使用者（如会话）通常在操作里持有自己，不完成它们就永远不会释放。
+    // 此时所属 io_context 已经停止，直接在当前线程上回调；回调中不会再提交新操作
+    while(_in_flight != nullptr){
+        IoUringOp* op = _in_flight;
+        Untrack(op);
+        op->Complete(-ECANCELED);
+    }
+    boost::system::error_code ec;
+    if(_event.is_open()){
+        _event.close(ec); // 同时关闭 _event_fd
+        _event_fd = -1;
+    }
+    if(_event_fd >= 0){
+        ::close(_event_fd);
+        _event_fd = -1;
+    }
+    if(_sqes != nullptr){
+        ::munmap(_sqes, _sqes_size);
+        _sqes = nullptr;
+    }
+    if(_cq_ring != nullptr && _cq_ring != _sq_ring){
+        ::munmap(_cq_ring, _cq_ring_size);
+    }
+    _cq_ring = nullptr;
+    if(_sq_ring != nullptr){
+        ::munmap(_sq_ring, _sq_ring_size);
+        _sq_ring = nullptr;
+    }
+    // 关闭 ring 会取消内核中所有在途操作
+    if(_ring_fd >= 0){
+        ::close(_ring_fd);
+        _ring_fd = -1;
+    }
+}
+
+void IoUring::Start(){
+    WaitCompletions();
+}
+
+std::uint64_t IoUring::GetEnterCalls() const{
+    return _enter_calls;
+}
+
+void IoUring::Track(IoUringOp* op){
+    op->_prev = nullptr;
+    op->_next = _in_flight;
+    if(_in_flight != nullptr){
+        _in_flight->_prev = op;
+    }
+    _in_flight = op;
+}
+
+void IoUring::Untrack(IoUringOp* op){
+    if(op->_prev != nullptr){
+        op->_prev->_next = op->_next;
+    }else{
+        _in_flight = op->_next;
+    }
+    if(op->_next != nullptr){
+        op->_next->_prev = op->_prev;
+    }
+    op->_prev = op->_next = nullptr;
+}
+
+void IoUring::Recv(int fd, void* buffer, std::size_t length, IoUringOp* op){
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(buffer);
+    sqe->len = static_cast<std::uint32_t>(length);
+    sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+    Track(op);
+    ScheduleSubmit();
+}
+
+void IoUring::SendMsg(int fd, const msghdr* message, IoUringOp* op){
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(message);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+    Track(op);
+    ScheduleSubmit();
+}
+
+void* IoUring::NextSqe(){
+    // 没有 SQPOLL 时，io_uring_enter 返回前内核已取走提交的条目，提交一次即可腾出空间
+    if(_sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries){
+        Submit();
+    }
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(_sqes) + (_sq_local_tail & _sq_mask);
+    std::memset(sqe, 0, sizeof(*sqe));
+    ++_sq_local_tail;
+    return sqe;
+}
+
+void IoUring::ScheduleSubmit(){
+    if(_submit_scheduled){
+        return;
+    }
+    _submit_scheduled = true;
+    boost::asio::post(_ioc, [this](){
+        _submit_scheduled = false;
+        Submit();
+    });
+}
+
+void IoUring::Submit(){
+    // 发布尾部：之前对条目的写入对内核可见
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+    unsigned pending = _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    while(pending > 0){
+        int submitted = Enter(pending, 0, 0);
+        if(submitted < 0){
+            if(submitted == -EINTR){
+                continue;
+            }
+            // EBUSY / EAGAIN：完成队列积压，先处理完成事件再重试
+            if(submitted == -EBUSY || submitted == -EAGAIN){
+                Reap();
+                continue;
+            }
+            LOG_ERROR("io_uring_enter failed: ", std::strerror(-submitted));
+            return;
+        }
+        pending -= static_cast<unsigned>(submitted);
+    }
+}
+
+int IoUring::Enter(unsigned to_submit, unsigned min_complete, unsigned flags){
+    ++_enter_calls;
+    int ret = static_cast<int>(::syscall(__NR_io_uring_enter, _ring_fd, to_submit, min_complete, flags, nullptr, 0));
+    return ret < 0 ? -errno : ret;
+}
+
+void IoUring::WaitCompletions(){
+    _event.async_wait(boost::asio::posix::descriptor_base::wait_read, [this](const boost::system::error_code& error){
+        if(error){
+            return;
+        }
+        std::uint64_t value = 0;
+        [[maybe_unused]] ssize_t n = ::read(_event_fd, &value, sizeof(value));
+        Reap();
+        // 回调中产生的新操作在这里统一提交，不必等到下一轮
+        if(_submit_scheduled){
+            Submit();
+        }
+        WaitCompletions();
+    });
+}
+
+void IoUring::Reap(){
+    io_uring_cqe* cqes = static_cast<io_uring_cqe*>(_cqes);
+    for(;;){
+        unsigned head = *_cq_head;
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        if(head == tail){
+            // 完成队列曾经溢出时，积压的条目要进入内核一次才会搬回 CQ
+            if(__atomic_load_n(_sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW){
+                Enter(0, 0, IORING_ENTER_GETEVENTS);
+                if(__atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE) != head){
+                    continue;
+                }
+            }
+            return;
+        }
+        while(head != tail){
+            io_uring_cqe& cqe = cqes[head & _cq_mask];
+            IoUringOp* op = reinterpret_cast<IoUringOp*>(cqe.user_data);
+            int result = cqe.res;
+            // 先归还条目再回调，回调里可以继续提交新操作
+            ++head;
+            __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+            Untrack(op);
+            op->Complete(result);
+        }
+    }
+}
+
+#else // ASYNC_HAS_IO_URING
+
+// 不支持 io_uring 的平台：构造后 Valid() 为 false，Server 不会使用它，所有会话走 ASIO 后端（epoll / IOCP / kqueue）
+IoUring::IoUring(boost::asio::io_context& /*ioc*/, unsigned /*entries*/){
+    LOG_WARN("io_uring is not available on this platform");
+}
+IoUring::~IoUring() = default;
+void IoUring::Start(){}
+void IoUring::Recv(int, void*, std::size_t, IoUringOp*){}
+void IoUring::SendMsg(int, const msghdr*, IoUringOp*){}
+std::uint64_t IoUring::GetEnterCalls() const{
+    return 0;
+}
+
+#endif // ASYNC_HAS_IO_URING
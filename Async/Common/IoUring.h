@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <boost/asio.hpp>
+
+// 编译期开关：Linux 且有 <linux/io_uring.h> 时可用，编译时加 -DASYNC_DISABLE_IO_URING 可强制关闭
+// 不依赖 liburing，直接使用 io_uring_setup / io_uring_enter / io_uring_register 系统调用
+#if defined(__linux__) && __has_include(<linux/io_uring.h>) && !defined(ASYNC_DISABLE_IO_URING)
+#define ASYNC_HAS_IO_URING 1
+#endif
+
+struct msghdr;
+
+// IoUringOp: 一个在途操作，完成时在 IoUring 所属的 io_context 线程上调用 Complete
+// 由使用者嵌入在自己的对象中，在 Complete 之前必须保持有效；提交和完成都不分配内存
+// 提交后挂在 IoUring 的在途链表上（侵入式），IoUring 销毁时仍未完成的操作以 -ECANCELED 完成
+class IoUringOp{
+public:
+    // result 为对应系统调用的返回值，出错时为 -errno
+    virtual void Complete(int result) = 0;
+protected:
+    ~IoUringOp() = default;
+private:
+    friend class IoUring;
+    IoUringOp* _prev = nullptr;
+    IoUringOp* _next = nullptr;
+};
+
+// IoUring: 每个 IO 线程一个 io_uring 实例，负责该线程上会话的 recv / sendmsg
+// 设计原理：
+// 1. 提交：Recv / SendMsg 只填写提交队列 (SQ)，当前这批回调执行完后由一次 io_uring_enter 统一提交，
+//    同一轮中多个会话的读写合并成一次系统调用。SQ 满时立即提交。
+// 2. 完成：ring 注册一个 eventfd，由所属 io_context 的 reactor 监听；可读时一次取完完成队列 (CQ) 中的所有条目，
+//    逐个调用 Complete，回调仍在该 IO 线程上串行执行，会话的线程模型不变。
+// 3. 只能在所属 io_context 线程上使用；构造失败（内核不支持或被禁用）时 Valid() 返回 false，调用方应退回 ASIO 后端。
+// 4. 没有 ASYNC_HAS_IO_URING 时（Windows、macOS 或 -DASYNC_DISABLE_IO_URING）只保留一个不含任何 POSIX 类型的空实现，
+//    Valid() 总是 false，不向 io_context 注册任何东西。
+class IoUring{
+public:
+    IoUring(boost::asio::io_context& ioc, unsigned entries = 4096);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    bool Valid() const{
+        return _ring_fd >= 0;
+    }
+    // 开始监听完成事件，需在所属 io_context 线程上调用
+    void Start();
+
+    // 从 fd 读取至多 length 字节到 buffer，等价于 recv(fd, buffer, length, 0)
+    void Recv(int fd, void* buffer, std::size_t length, IoUringOp* op);
+    // 等价于 sendmsg(fd, message, MSG_NOSIGNAL)；message 及其 iovec 在完成前必须保持有效
+    void SendMsg(int fd, const msghdr* message, IoUringOp* op);
+
+    // io_uring_enter 调用次数，用于和 epoll 后端对比系统调用数
+    std::uint64_t GetEnterCalls() const;
+
+private:
+    int _ring_fd = -1;
+
+#ifdef ASYNC_HAS_IO_URING
+    // 取一个空闲的提交队列条目，SQ 满时先提交
+    void* NextSqe();
+    // 提交所有已填写的条目
+    void Submit();
+    // 本轮回调结束后提交一次
+    void ScheduleSubmit();
+    // 等待 eventfd 可读
+    void WaitCompletions();
+    // 处理完成队列中的所有条目
+    void Reap();
+    int Enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+    // 在途链表：提交时挂入，完成时摘除
+    void Track(IoUringOp* op);
+    void Untrack(IoUringOp* op);
+    // 让仍在途的操作以 -ECANCELED 完成，再解除映射并关闭 fd，之后 Valid() 返回 false
+    void Release();
+
+    boost::asio::io_context& _ioc;
+    int _event_fd = -1;
+    boost::asio::posix::stream_descriptor _event;
+    bool _submit_scheduled = false;
+    std::uint64_t _enter_calls = 0;
+    // 已提交（或已填写待提交）尚未完成的操作
+    IoUringOp* _in_flight = nullptr;
+
+    // mmap 得到的共享内存
+    void* _sq_ring = nullptr;
+    void* _cq_ring = nullptr;
+    void* _sqes = nullptr;
+    std::size_t _sq_ring_size = 0;
+    std::size_t _cq_ring_size = 0;
+    std::size_t _sqes_size = 0;
+
+    // SQ / CQ 的各个字段，指向共享内存
+    unsigned* _sq_head = nullptr;
+    unsigned* _sq_tail = nullptr;
+    unsigned* _sq_flags = nullptr;
+    unsigned _sq_mask = 0;
+    unsigned _sq_entries = 0;
+    unsigned _sq_local_tail = 0; // 已填写但可能尚未发布给内核的尾部
+    unsigned* _cq_head = nullptr;
+    unsigned* _cq_tail = nullptr;
+    unsigned _cq_mask = 0;
+    void* _cqes = nullptr;
+#endif
+};
@@ -0,0 +1,180 @@
+#include "Logger.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 每个线程一个环形缓冲区：所属线程写 head，写线程写 tail
+struct Logger::ThreadBuffer{
+    Record records[RING_SIZE];
+    alignas(64) std::atomic<std::uint64_t> head{0}; // 下一个写入位置，仅生产者修改
+    alignas(64) std::atomic<std::uint64_t> tail{0}; // 下一个读取位置，仅写线程修改
+    std::atomic<std::uint64_t> dropped{0};          // 缓冲区满时丢弃的行数
+    std::atomic<bool> retired{false};               // 所属线程已退出，写完后可回收
+    std::uint32_t thread_no = 0;                    // 线程编号，用于输出
+};
+
+struct Logger::Impl{
+    std::mutex lock; // 保护 buffers 列表（仅在线程首次写日志和写线程回收时使用）
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::uint32_t next_thread_no = 0;
+    std::thread writer;
+    std::mutex wait_lock;
+    std::condition_variable wait_cv;
+    bool stop = false;
+};
+
+namespace{
+
+// 线程退出时把缓冲区标记为已退出，由写线程写完后回收
+struct LocalBufferHolder{
+    std::shared_ptr<Logger::ThreadBuffer> buffer;
+    ~LocalBufferHolder(){
+        if(buffer){
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local LocalBufferHolder t_holder;
+
+const char* LevelName(int level){
+    switch(level){
+    case LOG_LEVEL_DEBUG: return "DEBUG";
+    case LOG_LEVEL_INFO:  return "INFO ";
+    case LOG_LEVEL_WARN:  return "WARN ";
+    case LOG_LEVEL_ERROR: return "ERROR";
+    default:              return "?????";
+    }
+}
+
+} // namespace
+
+Logger& Logger::GetInstance(){
+    static Logger instance;
+    return instance;
+}
+
+Logger::Logger():_impl(std::make_unique<Impl>()){
+    _impl->writer = std::thread(&Logger::WriterLoop, this);
+}
+
+Logger::~Logger(){
+    Stop();
+}
+
+void Logger::Stop(){
+    {
+        std::lock_guard<std::mutex> lock(_impl->wait_lock);
+        if(_impl->stop){
+            return;
+        }
+        _impl->stop = true;
+    }
+    _impl->wait_cv.notify_one();
+    if(_impl->writer.joinable()){
+        _impl->writer.join();
+    }
+}
+
+Logger::ThreadBuffer& Logger::LocalBuffer(){
+    if(!t_holder.buffer){
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(_impl->lock);
+        buffer->thread_no = _impl->next_thread_no++;
+        _impl->buffers.push_back(buffer);
+        t_holder.buffer = std::move(buffer);
+    }
+    return *t_holder.buffer;
+}
+
+Logger::Record* Logger::BeginRecord(int level){
+    ThreadBuffer& buffer = LocalBuffer();
+    std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if(head - buffer.tail.load(std::memory_order_acquire) >= RING_SIZE){
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Record& record = buffer.records[head % RING_SIZE];
+    record.level = static_cast<std::uint8_t>(level);
+    record.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return &record;
+}
+
+void Logger::CommitRecord(){
+    ThreadBuffer& buffer = *t_holder.buffer;
+    buffer.head.store(buffer.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void Logger::WriterLoop(){
+    for(;;){
+        std::size_t written = Drain();
+        std::unique_lock<std::mutex> lock(_impl->wait_lock);
+        if(_impl->stop){
+            lock.unlock();
+            Drain();
+            return;
+        }
+        // 本轮没有日志时多等一会儿，降低空闲时的轮询开销
+        _impl->wait_cv.wait_for(lock, std::chrono::milliseconds(written > 0 ? 1 : 10));
+    }
+}
+
+std::size_t Logger::Drain(){
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_impl->lock);
+        buffers = _impl->buffers;
+    }
+
+    std::size_t written = 0;
+    char prefix[64];
+    for(auto& buffer : buffers){
+        std::uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for(; tail != head; ++tail){
+            const Record& record = buffer->records[tail % RING_SIZE];
+            std::time_t seconds = static_cast<std::time_t>(record.timestamp_us / 1000000);
+            std::tm tm_time;
+#ifdef _WIN32
+            localtime_s(&tm_time, &seconds);
+#else
+            localtime_r(&seconds, &tm_time);
+#endif
+            int n = std::snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%06d [%s] [T%u] ",
+                tm_time.tm_hour, tm_time.tm_min, tm_time.tm_sec, static_cast<int>(record.timestamp_us % 1000000),
+                LevelName(record.level), buffer->thread_no);
+            std::fwrite(prefix, 1, n, stdout);
+            std::fwrite(record.text, 1, record.length, stdout);
+            std::fputc('\n', stdout);
+            ++written;
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+
+        std::uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+        if(dropped > 0){
+            std::fprintf(stdout, "[WARN ] [T%u] %llu log lines dropped (buffer full)\n",
+                buffer->thread_no, static_cast<unsigned long long>(dropped));
+        }
+    }
+    if(written > 0){
+        std::fflush(stdout);
+    }
+
+    // 回收已退出且已写完的线程缓冲区
+    std::lock_guard<std::mutex> lock(_impl->lock);
+    for(auto iter = _impl->buffers.begin(); iter != _impl->buffers.end();){
+        ThreadBuffer& buffer = **iter;
+        if(buffer.retired.load(std::memory_order_acquire)
+            && buffer.tail.load(std::memory_order_relaxed) == buffer.head.load(std::memory_order_acquire)){
+            iter = _impl->buffers.erase(iter);
+        }else{
+            ++iter;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 日志级别
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF   4
+
+// 编译期日志级别：低于该级别的日志在预处理阶段就被移除，参数不会被求值
+// 编译时可通过 -DLOG_ACTIVE_LEVEL=LOG_LEVEL_DEBUG 调整
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL LOG_LEVEL_INFO
+#endif
+
+// LogLine: 把参数依次格式化到一块定长缓冲区，超出部分截断
+class LogLine{
+public:
+    LogLine(char* buffer, std::size_t capacity):_buffer(buffer), _capacity(capacity){}
+
+    std::size_t Length() const{ return _length; }
+
+    void Append(std::string_view str){
+        std::size_t n = str.size() < _capacity - _length ? str.size() : _capacity - _length;
+        ::memcpy(_buffer + _length, str.data(), n);
+        _length += n;
+    }
+    void Append(const char* str){ Append(std::string_view(str)); }
+    void Append(const std::string& str){ Append(std::string_view(str)); }
+    void Append(char c){
+        if(_length < _capacity){
+            _buffer[_length++] = c;
+        }
+    }
+    void Append(bool b){ Append(b ? std::string_view("true") : std::string_view("false")); }
+    void Append(const void* ptr){
+        Append(std::string_view("0x"));
+        AppendNumber(reinterpret_cast<std::uintptr_t>(ptr), 16);
+    }
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T>> Append(T value){
+        AppendNumber(value, 10);
+    }
+    template <typename T>
+    std::enable_if_t<std::is_floating_point_v<T>> Append(T value){
+        auto result = std::to_chars(_buffer + _length, _buffer + _capacity, static_cast<double>(value), std::chars_format::general, 6);
+        if(result.ec == std::errc()){
+            _length = result.ptr - _buffer;
+        }
+    }
+    // 其他类型（如 ip::address）通过 to_string() 转换
+    template <typename T>
+    auto Append(const T& value) -> decltype(value.to_string(), void()){
+        Append(value.to_string());
+    }
+
+private:
+    template <typename T>
+    void AppendNumber(T value, int base){
+        auto result = std::to_chars(_buffer + _length, _buffer + _capacity, value, base);
+        if(result.ec == std::errc()){
+            _length = result.ptr - _buffer;
+        }
+    }
+
+    char* _buffer;
+    std::size_t _capacity;
+    std::size_t _length = 0;
+};
+
+// Logger: 异步日志
+// 设计原理：
+// 1. 每个线程拥有一个无锁的单生产者单消费者环形缓冲区，业务线程只把格式化好的一行写进自己的缓冲区，不加锁、不做 IO。
+// 2. 后台写线程定期轮询所有线程的缓冲区，批量写到 stdout 后只 flush 一次。
+// 3. 缓冲区写满时丢弃新日志并计数，不会阻塞业务线程；丢弃数会由写线程报告。
+class Logger{
+public:
+    static Logger& GetInstance();
+
+    template <typename... Args>
+    void Write(int level, const Args&... args){
+        Record* record = BeginRecord(level);
+        if(record == nullptr){
+            return;
+        }
+        LogLine line(record->text, sizeof(record->text));
+        (line.Append(args), ...);
+        record->length = static_cast<std::uint16_t>(line.Length());
+        CommitRecord();
+    }
+
+    // 停止写线程，退出前把所有缓冲区写完
+    void Stop();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // 每行日志最大长度与每个线程缓冲区的行数
+    enum{LINE_SIZE = 240, RING_SIZE = 1024};
+
+    struct Record{
+        std::int64_t timestamp_us;
+        std::uint16_t length;
+        std::uint8_t level;
+        char text[LINE_SIZE];
+    };
+
+    struct ThreadBuffer;
+
+private:
+    Logger();
+    ~Logger();
+    // 在当前线程的缓冲区中占用一个槽位，缓冲区已满时返回 nullptr
+    Record* BeginRecord(int level);
+    // 发布 BeginRecord 占用的槽位
+    void CommitRecord();
+    ThreadBuffer& LocalBuffer();
+    // 写线程主循环
+    void WriterLoop();
+    // 把所有缓冲区中的日志写出，返回写出的行数
+    std::size_t Drain();
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::GetInstance().Write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::GetInstance().Write(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::GetInstance().Write(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::GetInstance().Write(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
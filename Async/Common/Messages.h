@@ -0,0 +1,22 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "MsgId.h"
+#include "MsgSchema.h"
+
+// 类型化消息定义：服务器与客户端共用，线上布局见 MsgSchema.h
+
+// MSG_POSITION：实体位置和朝向，编码后 42 字节
+struct PositionMsg{
+    static constexpr std::uint16_t MSG_ID = MSG_POSITION;
+
+    std::uint64_t entity_id = 0;
+    std::uint32_t seq = 0;            // 发送方递增的序号
+    float x = 0, y = 0, z = 0;
+    std::int16_t yaw = 0;             // 朝向，单位 0.01 度
+    std::uint8_t state = 0;
+    std::array<char, 15> name{};      // 定长名称，不足补 0
+
+    MSG_FIELDS(entity_id, seq, x, y, z, yaw, state, name)
+};
+static_assert(MsgWireSize<PositionMsg> == 42);
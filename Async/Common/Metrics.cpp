@@ -0,0 +1,239 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdarg>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace{
+
+struct CounterInfo{
+    const char* name;
+    const char* help;
+    bool gauge;
+};
+
+const CounterInfo COUNTER_INFOS[Metrics::COUNTER_COUNT] = {
+    {"connections_accepted_total", "Accepted connections.", false},
+    {"connections_closed_total", "Closed connections.", false},
+    {"bytes_in_total", "Bytes received.", false},
+    {"bytes_out_total", "Bytes sent.", false},
+    {"frames_in_total", "Frames received.", false},
+    {"frames_out_total", "Frames sent.", false},
+    {"parse_errors_total", "Connections closed because of an invalid frame header.", false},
+    {"dropped_messages_total", "Messages dropped because a send queue exceeded its limit.", false},
+    {"bad_length_messages_total", "Received messages dropped because their length did not match the fixed-size message schema.", false},
+    {"idle_timeouts_total", "Connections closed by the idle timeout.", false},
+    {"write_timeouts_total", "Connections closed by the write timeout.", false},
+    {"send_queue_bytes", "Bytes queued but not yet written, summed over all sessions.", true},
+};
+
+const CounterInfo HISTOGRAM_INFOS[Metrics::HISTOGRAM_COUNT] = {
+    {"write_latency", "Time from issuing a gathered write to its completion.", false},
+    {"handler_latency", "Time spent in a logic handler per message.", false},
+};
+
+const char* PREFIX = "asyncserver_";
+
+// 所属线程写、其他线程读的计数，relaxed 读写在 x86 上就是普通的 mov
+using Slot = std::atomic<std::uint64_t>;
+
+void Bump(Slot& slot, std::uint64_t value){
+    slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct HistogramSlots{
+    Slot count{0};
+    Slot sum{0};
+    Slot max{0};
+    Slot buckets[Metrics::BUCKET_COUNT] = {};
+};
+
+struct ThreadMetrics;
+
+// 所有线程指标槽的登记表
+struct MetricsRegistry{
+    std::mutex lock;
+    std::vector<ThreadMetrics*> threads;
+    // 已退出线程的数值
+    Metrics::Snapshot retired;
+};
+
+MetricsRegistry& Registry(){
+    static MetricsRegistry* registry = new MetricsRegistry(); // 故意不析构，线程退出可能晚于静态对象析构
+    return *registry;
+}
+
+void Accumulate(const ThreadMetrics& metrics, Metrics::Snapshot& snapshot);
+
+// 每个线程一份，独占缓存行，避免与其他线程的槽位伪共享
+struct alignas(64) ThreadMetrics{
+    Slot counters[Metrics::COUNTER_COUNT] = {};
+    HistogramSlots histograms[Metrics::HISTOGRAM_COUNT];
+
+    ThreadMetrics(){
+        auto& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.lock);
+        registry.threads.push_back(this);
+    }
+
+    ~ThreadMetrics(){
+        auto& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.lock);
+        Accumulate(*this, registry.retired);
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+    }
+};
+
+void Accumulate(const ThreadMetrics& metrics, Metrics::Snapshot& snapshot){
+    for(int i = 0; i < Metrics::COUNTER_COUNT; ++i){
+        snapshot.counters[i] += metrics.counters[i].load(std::memory_order_relaxed);
+    }
+    for(int i = 0; i < Metrics::HISTOGRAM_COUNT; ++i){
+        const HistogramSlots& from = metrics.histograms[i];
+        Metrics::HistogramSnapshot& to = snapshot.histograms[i];
+        to.count += from.count.load(std::memory_order_relaxed);
+        to.sum += from.sum.load(std::memory_order_relaxed);
+        to.max = std::max(to.max, from.max.load(std::memory_order_relaxed));
+        for(int b = 0; b < Metrics::BUCKET_COUNT; ++b){
+            to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+thread_local ThreadMetrics t_metrics;
+
+void AppendFormat(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void AppendFormat(std::string& out, const char* format, ...){
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if(length > 0){
+        out.append(buffer, std::min<std::size_t>(length, sizeof(buffer) - 1));
+    }
+}
+
+// 第 b 个桶的上界（纳秒）
+double BucketBound(int bucket){
+    return static_cast<double>(std::uint64_t(1) << std::min(bucket, 63)) * (bucket == 64 ? 2.0 : 1.0);
+}
+
+} // namespace
+
+void Metrics::Add(Counter counter, std::uint64_t value){
+    Bump(t_metrics.counters[counter], value);
+}
+
+void Metrics::Record(Histogram histogram, std::uint64_t value){
+    HistogramSlots& slots = t_metrics.histograms[histogram];
+    Bump(slots.count, 1);
+    Bump(slots.sum, value);
+    Bump(slots.buckets[std::bit_width(value)], 1);
+    if(value > slots.max.load(std::memory_order_relaxed)){
+        slots.max.store(value, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t Metrics::NowNs(){
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::uint64_t Metrics::HistogramSnapshot::Percentile(double quantile) const{
+    if(count == 0){
+        return 0;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(quantile * static_cast<double>(count));
+    std::uint64_t seen = 0;
+    for(int b = 0; b < BUCKET_COUNT; ++b){
+        seen += buckets[b];
+        if(seen > rank){
+            return std::min(max, static_cast<std::uint64_t>(BucketBound(b)));
+        }
+    }
+    return max;
+}
+
+Metrics::Snapshot Metrics::Collect(){
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    Snapshot snapshot = registry.retired;
+    for(ThreadMetrics* metrics : registry.threads){
+        Accumulate(*metrics, snapshot);
+    }
+    return snapshot;
+}
+
+std::string Metrics::ToPrometheus(const Snapshot& snapshot){
+    std::string out;
+    out.reserve(4096);
+    for(int i = 0; i < COUNTER_COUNT; ++i){
+        const CounterInfo& info = COUNTER_INFOS[i];
+        AppendFormat(out, "# HELP %s%s %s\n# TYPE %s%s %s\n", PREFIX, info.name, info.help,
+            PREFIX, info.name, info.gauge ? "gauge" : "counter");
+        if(info.gauge){
+            AppendFormat(out, "%s%s %lld\n", PREFIX, info.name, static_cast<long long>(snapshot.counters[i]));
+        }else{
+            AppendFormat(out, "%s%s %llu\n", PREFIX, info.name, static_cast<unsigned long long>(snapshot.counters[i]));
+        }
+    }
+    std::uint64_t active = snapshot.counters[CONNECTIONS_ACCEPTED] - snapshot.counters[CONNECTIONS_CLOSED];
+    AppendFormat(out, "# HELP %sconnections_active Open connections.\n# TYPE %sconnections_active gauge\n"
+        "%sconnections_active %lld\n", PREFIX, PREFIX, PREFIX, static_cast<long long>(active));
+
+    for(int i = 0; i < HISTOGRAM_COUNT; ++i){
+        const CounterInfo& info = HISTOGRAM_INFOS[i];
+        const HistogramSnapshot& histogram = snapshot.histograms[i];
+        AppendFormat(out, "# HELP %s%s_seconds %s\n# TYPE %s%s_seconds histogram\n", PREFIX, info.name, info.help,
+            PREFIX, info.name);
+        // 只输出到最后一个非空桶，之后的桶与 +Inf 相同
+        int last = BUCKET_COUNT - 1;
+        while(last > 0 && histogram.buckets[last] == 0){
+            --last;
+        }
+        std::uint64_t cumulative = 0;
+        for(int b = 0; b <= last; ++b){
+            cumulative += histogram.buckets[b];
+            AppendFormat(out, "%s%s_seconds_bucket{le=\"%.9g\"} %llu\n", PREFIX, info.name, BucketBound(b) / 1e9,
+                static_cast<unsigned long long>(cumulative));
+        }
+        AppendFormat(out, "%s%s_seconds_bucket{le=\"+Inf\"} %llu\n", PREFIX, info.name,
+            static_cast<unsigned long long>(histogram.count));
+        AppendFormat(out, "%s%s_seconds_sum %.9g\n", PREFIX, info.name, static_cast<double>(histogram.sum) / 1e9);
+        AppendFormat(out, "%s%s_seconds_count %llu\n", PREFIX, info.name, static_cast<unsigned long long>(histogram.count));
+    }
+    return out;
+}
+
+std::string Metrics::ToJson(const Snapshot& snapshot){
+    std::string out = "{";
+    for(int i = 0; i < COUNTER_COUNT; ++i){
+        const CounterInfo& info = COUNTER_INFOS[i];
+        if(info.gauge){
+            AppendFormat(out, "\"%s\":%lld,", info.name, static_cast<long long>(snapshot.counters[i]));
+        }else{
+            AppendFormat(out, "\"%s\":%llu,", info.name, static_cast<unsigned long long>(snapshot.counters[i]));
+        }
+    }
+    AppendFormat(out, "\"connections_active\":%lld", static_cast<long long>(
+        snapshot.counters[CONNECTIONS_ACCEPTED] - snapshot.counters[CONNECTIONS_CLOSED]));
+    for(int i = 0; i < HISTOGRAM_COUNT; ++i){
+        const HistogramSnapshot& histogram = snapshot.histograms[i];
+        AppendFormat(out, ",\"%s_ns\":{\"count\":%llu,\"mean\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,"
+            "\"p999\":%llu,\"max\":%llu}", HISTOGRAM_INFOS[i].name,
+            static_cast<unsigned long long>(histogram.count),
+            static_cast<unsigned long long>(histogram.count ? histogram.sum / histogram.count : 0),
+            static_cast<unsigned long long>(histogram.Percentile(0.50)),
+            static_cast<unsigned long long>(histogram.Percentile(0.90)),
+            static_cast<unsigned long long>(histogram.Percentile(0.99)),
+            static_cast<unsigned long long>(histogram.Percentile(0.999)),
+            static_cast<unsigned long long>(histogram.max));
+    }
+    out += "}\n";
+    return out;
+}
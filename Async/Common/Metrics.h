@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Metrics: 进程内指标（计数器、仪表和直方图）
+// 设计原理：
+// 1. 每个线程一份指标槽，只有所属线程会写，记录时用 relaxed 读 + 写，没有 lock 前缀也没有跨核缓存行争用。
+// 2. 读取时 (Collect) 加锁遍历所有线程的槽位求和，已退出线程的数值并入登记表，不会丢失。
+// 3. 仪表（如发送队列字节数）同样按线程累加：增加和减少可能发生在不同线程，单个线程的值可能为“负”，求和后才有意义。
+// 4. 直方图按 2 的幂分桶，记录只需一次 bit_width 和三次写。
+class Metrics{
+public:
+    enum Counter{
+        CONNECTIONS_ACCEPTED, // 接受的连接
+        CONNECTIONS_CLOSED,   // 关闭的连接
+        BYTES_IN,             // 接收字节
+        BYTES_OUT,            // 发送字节
+        FRAMES_IN,            // 接收帧
+        FRAMES_OUT,           // 发送帧
+        PARSE_ERRORS,         // 帧头非法
+        DROPPED_MESSAGES,     // 发送队列超过硬上限被丢弃的消息
+        BAD_LENGTH_MESSAGES,  // 长度与定长消息定义不符被丢弃的消息（连接保持）
+        IDLE_TIMEOUTS,        // 空闲超时断开
+        WRITE_TIMEOUTS,       // 写超时断开
+        SEND_QUEUE_BYTES,     // 仪表：所有会话发送队列中尚未写完的字节数
+        COUNTER_COUNT
+    };
+    enum Histogram{
+        WRITE_LATENCY,   // 一次合并写从发起到完成的耗时（纳秒）
+        HANDLER_LATENCY, // 逻辑层处理一条消息的耗时（纳秒）
+        HISTOGRAM_COUNT
+    };
+    // 第 i 个桶统计 [2^(i-1), 2^i) 的值，第 0 个桶统计 0
+    enum{BUCKET_COUNT = 65};
+
+    // 以下记录函数可在任意线程调用
+    static void Add(Counter counter, std::uint64_t value = 1);
+    static void Sub(Counter counter, std::uint64_t value){
+        Add(counter, 0 - value);
+    }
+    static void Record(Histogram histogram, std::uint64_t value);
+    // 单调时钟的纳秒数，用于计算耗时
+    static std::uint64_t NowNs();
+
+    struct HistogramSnapshot{
+        std::uint64_t count = 0;
+        std::uint64_t sum = 0;
+        std::uint64_t max = 0;
+        std::uint64_t buckets[BUCKET_COUNT] = {};
+        // 近似分位数：返回所在桶的上界（不超过 max）
+        std::uint64_t Percentile(double quantile) const;
+    };
+    struct Snapshot{
+        std::uint64_t counters[COUNTER_COUNT] = {};
+        HistogramSnapshot histograms[HISTOGRAM_COUNT];
+    };
+    // 汇总所有线程
+    static Snapshot Collect();
+
+    // Prometheus 文本格式 (text/plain; version=0.0.4)，耗时以秒为单位
+    static std::string ToPrometheus(const Snapshot& snapshot);
+    // JSON，耗时以纳秒为单位，直方图只给出分位数
+    static std::string ToJson(const Snapshot& snapshot);
+};
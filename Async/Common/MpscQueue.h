@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <new>
+#include <utility>
+#include "BufferPool.h"
+
+// MpscQueue: 无锁多生产者单消费者队列 (Vyukov MPSC)
+// 设计原理：
+// 1. 队列是一条单向链表，_head 指向最后入队的节点，_tail 指向哨兵节点，哨兵的 next 才是队首元素。
+// 2. 入队只需一次 exchange 抢占 _head，再把前驱的 next 指向新节点，任意线程都可以并发调用，不会阻塞。
+// 3. 出队只能由一个消费者线程调用：取出哨兵之后的元素，并让该节点成为新的哨兵。
+// 4. 链表节点从 BufferPool 分配，元素本身不需要内嵌 next 指针，同一个元素可以同时位于多个队列中。
+// 注意：入队在 exchange 与写 next 之间有一个短暂窗口，此时 Pop/Peek 会暂时看不到该元素，
+//      调用方需要在入队完成之后再做“是否需要唤醒消费者”的判断。
+template <typename T>
+class MpscQueue{
+public:
+    MpscQueue():_head(&_stub), _tail(&_stub){}
+
+    ~MpscQueue(){
+        T value;
+        while(Pop(value)){
+        }
+        // 最后一个出队的节点仍作为哨兵留在链表中
+        if(_tail != &_stub){
+            _tail->~Node();
+            BufferPool::Deallocate(_tail, sizeof(Node));
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // 入队，任意线程可调用
+    void Push(T value){
+        Node* node = new (BufferPool::Allocate(sizeof(Node))) Node(std::move(value));
+        Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 出队，仅消费者线程调用；队列为空返回 false
+    bool Pop(T& value){
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if(next == nullptr){
+            return false;
+        }
+        value = std::move(next->value);
+        _tail = next;
+        if(tail != &_stub){
+            tail->~Node();
+            BufferPool::Deallocate(tail, sizeof(Node));
+        }
+        return true;
+    }
+
+    // 查看队首元素但不出队，仅消费者线程调用；队列为空返回 nullptr
+    T* Peek(){
+        Node* next = _tail->next.load(std::memory_order_acquire);
+        return next == nullptr ? nullptr : &next->value;
+    }
+
+    // 仅消费者线程调用
+    bool Empty() const{
+        return _tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node{
+        Node() = default;
+        explicit Node(T v):value(std::move(v)){}
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    // 生产者和消费者访问的指针放在不同的缓存行，避免伪共享
+    alignas(64) std::atomic<Node*> _head;
+    alignas(64) Node* _tail;
+    Node _stub;
+};
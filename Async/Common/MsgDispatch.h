@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "MsgSchema.h"
+
+// MsgDispatch: 编译期生成的消息分发表，header-only
+// 用法：把路由作为模板参数列出，MsgDispatcher 在编译期按消息ID生成一张稠密跳转表
+//
+//     void OnEcho(Ctx ctx, short msg_id, const char* data, int length);   // 原始字节
+//     void OnPosition(Ctx ctx, const PositionMsg& msg);                   // 类型化消息
+//     using Dispatcher = MsgDispatcher<Ctx, RawRoute<MSG_ECHO, &OnEcho>, TypedRoute<&OnPosition>>;
+//
+// 1. 查表：下标为 msg_id - 最小ID，越界或空位即未注册；一次减法、一次比较、一次间接调用，没有 map 查找和 std::function。
+// 2. 处理函数是模板参数，跳转表里存的是为每条路由实例化的入口函数，入口内对处理函数是直接调用，可以内联。
+// 3. 类型化路由的入口先按 MsgSchema 解码到栈上再调用处理函数；表项带有定长，调用方可以在拷贝消息之前校验长度。
+// 4. 同一ID注册两次、ID 过于稀疏（表超过 MAX_TABLE_SIZE 项）都在编译期报错；ID 目前从 1001 起连续分配，稠密表足够，不需要完美哈希。
+
+// 跳转表的一项
+template <typename Ctx>
+struct MsgRoute{
+    // 处理入口：类型化消息长度不符时返回 false，不调用处理函数
+    using Thunk = bool(*)(Ctx ctx, short msg_id, const char* data, int length);
+    Thunk handler = nullptr;
+    int wire_size = -1; // 类型化消息的定长（MsgWireSize），-1 表示原始字节，不校验长度
+};
+
+// 原始字节路由：Handler(ctx, msg_id, data, length)
+template <std::uint16_t Id, auto Handler>
+struct RawRoute{
+    static constexpr std::uint16_t MSG_ID = Id;
+    static constexpr int WIRE_SIZE = -1;
+
+    template <typename Ctx>
+    static bool Invoke(Ctx ctx, short msg_id, const char* data, int length){
+        Handler(ctx, msg_id, data, length);
+        return true;
+    }
+};
+
+namespace msg_dispatch_detail{
+
+// 从处理函数的签名 void(Ctx, const Msg&) 推导消息类型
+template <typename F>
+struct HandlerTraits;
+template <typename C, typename M>
+struct HandlerTraits<void(*)(C, const M&)>{
+    using Msg = M;
+};
+
+template <std::uint16_t... Ids>
+constexpr bool UniqueIds(){
+    std::array<std::uint16_t, sizeof...(Ids)> ids{Ids...};
+    std::sort(ids.begin(), ids.end());
+    return std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+}
+
+// 按 MSG_ID - MinId 把各路由的入口填进表，其余位置为空
+template <typename Ctx, std::uint16_t MinId, std::size_t Size, typename... Routes>
+constexpr std::array<MsgRoute<Ctx>, Size> BuildTable(){
+    std::array<MsgRoute<Ctx>, Size> table{};
+    ((table[Routes::MSG_ID - MinId] = MsgRoute<Ctx>{&Routes::template Invoke<Ctx>, Routes::WIRE_SIZE}), ...);
+    return table;
+}
+
+} // namespace msg_dispatch_detail
+
+// 类型化路由：消息ID取 Msg::MSG_ID，消息体解码后调用 Handler(ctx, msg)
+template <auto Handler>
+struct TypedRoute{
+    using Msg = typename msg_dispatch_detail::HandlerTraits<decltype(Handler)>::Msg;
+    static_assert(TypedMsg<Msg>, "TypedRoute handler must take a MsgSchema message with MSG_ID");
+    static constexpr std::uint16_t MSG_ID = Msg::MSG_ID;
+    static constexpr int WIRE_SIZE = static_cast<int>(MsgWireSize<Msg>);
+
+    template <typename Ctx>
+    static bool Invoke(Ctx ctx, short, const char* data, int length){
+        Msg msg;
+        if(!DecodeMsg(data, static_cast<std::size_t>(length), msg)){
+            return false;
+        }
+        Handler(ctx, msg);
+        return true;
+    }
+};
+
+template <typename Ctx, typename... Routes>
+class MsgDispatcher{
+public:
+    using Route = MsgRoute<Ctx>;
+
+    static_assert(sizeof...(Routes) > 0, "MsgDispatcher needs at least one route");
+    static constexpr std::uint16_t MIN_ID = std::min({Routes::MSG_ID...});
+    static constexpr std::uint16_t MAX_ID = std::max({Routes::MSG_ID...});
+    static constexpr std::size_t TABLE_SIZE = static_cast<std::size_t>(MAX_ID - MIN_ID) + 1;
+    static constexpr std::size_t MAX_TABLE_SIZE = 1024;
+    static_assert(TABLE_SIZE <= MAX_TABLE_SIZE, "message ids are too sparse for a dense dispatch table");
+
+    // 查找消息ID对应的表项，未注册返回 nullptr
+    static const Route* Find(std::uint16_t msg_id){
+        // 小于 MIN_ID 时无符号回绕成很大的下标，一次比较同时排除两端
+        std::size_t index = static_cast<std::uint16_t>(msg_id - MIN_ID);
+        if(index >= TABLE_SIZE || _table[index].handler == nullptr){
+            return nullptr;
+        }
+        return &_table[index];
+    }
+
+    // 查表并调用，未注册或长度不符时返回 false
+    static bool Dispatch(Ctx ctx, short msg_id, const char* data, int length){
+        const Route* route = Find(static_cast<std::uint16_t>(msg_id));
+        return route != nullptr && route->handler(ctx, msg_id, data, length);
+    }
+
+private:
+    static_assert(msg_dispatch_detail::UniqueIds<Routes::MSG_ID...>(), "duplicate message id in MsgDispatcher routes");
+
+    static constexpr std::array<Route, TABLE_SIZE> _table =
+        msg_dispatch_detail::BuildTable<Ctx, MIN_ID, TABLE_SIZE, Routes...>();
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+// 帧头格式（网络字节序 / 大端，共 8 字节）：
+// +---------+---------+-----------+-------------+
+// | version |  flags  |  msg_id   |   length    |
+// |  1 字节 |  1 字节 |  2 字节   |   4 字节    |
+// +---------+---------+-----------+-------------+
+// length 为消息体长度，不含帧头；服务器和客户端各自配置允许的最大帧长度。
+enum{
+    MSG_HEAD_VERSION = 1,  // 当前协议版本，版本不符的连接会被关闭
+    MSG_HEAD_LENGTH = 8,   // 帧头长度
+    MSG_REQUEST_ID_LENGTH = 4, // 请求 / 回复帧消息体开头的请求ID长度
+};
+
+// 帧头 flags 位定义
+// 压缩位：消息体是压缩后的数据（4 字节原始长度 + 压缩数据，见 Compression.h），length 为压缩后的长度。
+// 压缩算法在连接建立时协商（MSG_HELLO），协商之前双方都只发送未压缩的帧。
+// 请求 / 回复位：消息体开头是 4 字节请求ID（大端），之后才是消息本身，length 包含请求ID；
+// 压缩位只作用于请求ID之后的部分。请求ID由发起方分配，不为 0，回复方原样带回，发起方据此匹配在途的请求。
+enum MSG_FLAGS : std::uint8_t{
+    MSG_FLAG_NONE = 0,
+    MSG_FLAG_LZ4 = 0x01,        // LZ4 压缩
+    MSG_FLAG_ZLIB = 0x02,       // zlib (deflate) 压缩
+    MSG_FLAG_COMPRESSED = 0x03, // 压缩位掩码，一帧最多设置其中一位
+    MSG_FLAG_REQUEST = 0x04,    // 请求：期望对端以同一请求ID回复
+    MSG_FLAG_REPLY = 0x08,      // 回复：请求ID为所回复的请求
+};
+
+struct MsgHeader{
+    std::uint8_t version = MSG_HEAD_VERSION;
+    std::uint8_t flags = MSG_FLAG_NONE;
+    std::uint16_t msg_id = 0;
+    std::uint32_t length = 0;
+};
+
+// 按网络字节序写入 MSG_HEAD_LENGTH 字节，与本机字节序无关
+inline void EncodeMsgHeader(char* out, const MsgHeader& head){
+    unsigned char* p = reinterpret_cast<unsigned char*>(out);
+    p[0] = head.version;
+    p[1] = head.flags;
+    p[2] = static_cast<unsigned char>(head.msg_id >> 8);
+    p[3] = static_cast<unsigned char>(head.msg_id);
+    p[4] = static_cast<unsigned char>(head.length >> 24);
+    p[5] = static_cast<unsigned char>(head.length >> 16);
+    p[6] = static_cast<unsigned char>(head.length >> 8);
+    p[7] = static_cast<unsigned char>(head.length);
+}
+
+// 从 MSG_HEAD_LENGTH 字节中解析帧头
+inline MsgHeader DecodeMsgHeader(const char* in){
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+    MsgHeader head;
+    head.version = p[0];
+    head.flags = p[1];
+    head.msg_id = static_cast<std::uint16_t>((p[2] << 8) | p[3]);
+    head.length = (static_cast<std::uint32_t>(p[4]) << 24) | (static_cast<std::uint32_t>(p[5]) << 16)
+        | (static_cast<std::uint32_t>(p[6]) << 8) | static_cast<std::uint32_t>(p[7]);
+    return head;
+}
+
+// 请求ID按网络字节序读写 MSG_REQUEST_ID_LENGTH 字节
+inline void EncodeRequestId(char* out, std::uint32_t request_id){
+    unsigned char* p = reinterpret_cast<unsigned char*>(out);
+    p[0] = static_cast<unsigned char>(request_id >> 24);
+    p[1] = static_cast<unsigned char>(request_id >> 16);
+    p[2] = static_cast<unsigned char>(request_id >> 8);
+    p[3] = static_cast<unsigned char>(request_id);
+}
+
+inline std::uint32_t DecodeRequestId(const char* in){
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16)
+        | (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+}
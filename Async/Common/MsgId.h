@@ -0,0 +1,12 @@
+#pragma once
+
+// 消息ID定义：服务器与客户端共用
+enum MSG_IDS{
+    MSG_ECHO = 1001,      // 回显消息，服务器原样返回
+    MSG_BROADCAST = 1002, // 广播消息，服务器转发给所有在线会话（包括发送方）
+    MSG_HEARTBEAT = 1003, // 心跳，消息体为空；只刷新连接的活动时间，不交给业务逻辑
+    MSG_GOODBYE = 1004,   // 服务器即将关闭，消息体为空；之后不再处理新请求，已收到请求的回复仍会送达
+    MSG_HELLO = 1005,     // 连接协商：客户端发送 1 字节支持的压缩算法（MSG_FLAG_LZ4 | MSG_FLAG_ZLIB），
+                          // 服务器回复 1 字节选定的算法（0 表示不压缩），此后双方对超过阈值的帧使用该算法
+    MSG_POSITION = 1006,  // 实体位置，消息体为定长的 PositionMsg（见 Messages.h），服务器解码后原样回发
+};
@@ -0,0 +1,186 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// MsgSchema: 编译期反射的定长二进制消息，header-only
+// 用法：在结构体里用 MSG_FIELDS 列出参与编码的字段（按线上顺序），并给出消息ID
+//
+//     struct PositionMsg{
+//         static constexpr std::uint16_t MSG_ID = MSG_POSITION;
+//         std::uint64_t entity_id;
+//         float x, y, z;
+//         std::array<char, 16> name;
+//         MSG_FIELDS(entity_id, x, y, z, name)
+//     };
+//
+// 1. 布局：字段按 MSG_FIELDS 中的顺序紧密排列，没有填充和字段标签；MsgWireSize<T> 在编译期算出总长度。
+// 2. 字节序：整数、枚举按网络字节序（大端），浮点数按 IEEE 754 位模式的大端，与本机字节序和对齐无关。
+// 3. 支持的字段类型：bool、整数、枚举、float、double、std::array<字段类型, N>（char 数组即定长字符串），
+//    以及同样用 MSG_FIELDS 描述的嵌套结构体。不支持变长字段（string / vector），这类消息仍走 char* 接口。
+// 4. 编码 / 解码只读写调用方提供的缓冲区，不分配内存；解码要求长度恰好等于 MsgWireSize<T>。
+
+// 在结构体内声明字段列表：生成返回各字段引用的 MsgFieldsTie()，编解码据此遍历字段
+#define MSG_FIELDS(...)                                              \
+    auto MsgFieldsTie(){ return std::tie(__VA_ARGS__); }             \
+    auto MsgFieldsTie() const{ return std::tie(__VA_ARGS__); }
+
+namespace msg_schema_detail{
+
+// 用 MSG_FIELDS 描述的结构体
+template <typename T, typename = void>
+struct HasFields : std::false_type{};
+template <typename T>
+struct HasFields<T, std::void_t<decltype(std::declval<T&>().MsgFieldsTie())>> : std::true_type{};
+
+template <typename T>
+struct IsStdArray : std::false_type{};
+template <typename T, std::size_t N>
+struct IsStdArray<std::array<T, N>> : std::true_type{};
+
+// 标量按位宽映射到同宽的无符号整数，统一按大端读写
+template <typename T>
+using UnsignedOf = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+    std::conditional_t<sizeof(T) == 2, std::uint16_t,
+    std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+template <typename T>
+constexpr bool IsScalar = std::is_integral_v<T> || std::is_enum_v<T>
+    || (std::is_floating_point_v<T> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+template <typename T>
+constexpr std::size_t WireSize();
+
+template <typename Tuple, std::size_t... I>
+constexpr std::size_t TupleWireSize(std::index_sequence<I...>){
+    return (std::size_t{0} + ... + WireSize<std::remove_cvref_t<std::tuple_element_t<I, Tuple>>>());
+}
+
+template <typename T>
+constexpr std::size_t WireSize(){
+    if constexpr(std::is_same_v<T, bool>){
+        return 1;
+    }else if constexpr(IsScalar<T>){
+        return sizeof(T);
+    }else if constexpr(IsStdArray<T>::value){
+        return std::tuple_size_v<T> * WireSize<typename T::value_type>();
+    }else if constexpr(HasFields<T>::value){
+        using Tuple = decltype(std::declval<const T&>().MsgFieldsTie());
+        return TupleWireSize<Tuple>(std::make_index_sequence<std::tuple_size_v<Tuple>>());
+    }else{
+        static_assert(HasFields<T>::value, "unsupported message field type, use MSG_FIELDS or a fixed-size type");
+        return 0;
+    }
+}
+
+template <typename T>
+inline char* EncodeField(const T& value, char* out){
+    if constexpr(std::is_same_v<T, bool>){
+        *out = value ? 1 : 0;
+        return out + 1;
+    }else if constexpr(IsScalar<T>){
+        using U = UnsignedOf<T>;
+        U bits;
+        if constexpr(std::is_enum_v<T>){
+            bits = static_cast<U>(static_cast<std::underlying_type_t<T>>(value));
+        }else if constexpr(std::is_floating_point_v<T>){
+            bits = std::bit_cast<U>(value);
+        }else{
+            bits = static_cast<U>(value);
+        }
+        // 逐字节移位写入，编译器会合并成一次字节交换加一次存储
+        for(std::size_t i = 0; i < sizeof(U); ++i){
+            out[i] = static_cast<char>(bits >> (8 * (sizeof(U) - 1 - i)));
+        }
+        return out + sizeof(U);
+    }else if constexpr(IsStdArray<T>::value){
+        using V = typename T::value_type;
+        if constexpr(sizeof(V) == 1 && (std::is_integral_v<V> && !std::is_same_v<V, bool>)){
+            // 字节数组没有字节序问题，直接拷贝
+            std::memcpy(out, value.data(), value.size());
+            return out + value.size();
+        }else{
+            for(const V& element : value){
+                out = EncodeField(element, out);
+            }
+            return out;
+        }
+    }else{
+        std::apply([&out](const auto&... fields){
+            ((out = EncodeField(fields, out)), ...);
+        }, value.MsgFieldsTie());
+        return out;
+    }
+}
+
+template <typename T>
+inline const char* DecodeField(T& value, const char* in){
+    if constexpr(std::is_same_v<T, bool>){
+        value = *in != 0;
+        return in + 1;
+    }else if constexpr(IsScalar<T>){
+        using U = UnsignedOf<T>;
+        U bits = 0;
+        for(std::size_t i = 0; i < sizeof(U); ++i){
+            bits = static_cast<U>((bits << 8) | static_cast<unsigned char>(in[i]));
+        }
+        if constexpr(std::is_enum_v<T>){
+            value = static_cast<T>(static_cast<std::underlying_type_t<T>>(bits));
+        }else if constexpr(std::is_floating_point_v<T>){
+            value = std::bit_cast<T>(bits);
+        }else{
+            value = static_cast<T>(bits);
+        }
+        return in + sizeof(U);
+    }else if constexpr(IsStdArray<T>::value){
+        using V = typename T::value_type;
+        if constexpr(sizeof(V) == 1 && (std::is_integral_v<V> && !std::is_same_v<V, bool>)){
+            std::memcpy(value.data(), in, value.size());
+            return in + value.size();
+        }else{
+            for(V& element : value){
+                in = DecodeField(element, in);
+            }
+            return in;
+        }
+    }else{
+        std::apply([&in](auto&... fields){
+            ((in = DecodeField(fields, in)), ...);
+        }, value.MsgFieldsTie());
+        return in;
+    }
+}
+
+} // namespace msg_schema_detail
+
+// 消息 T 编码后的字节数，编译期常量
+template <typename T>
+inline constexpr std::size_t MsgWireSize = msg_schema_detail::WireSize<T>();
+
+// 带 MSG_ID 的消息才能通过 Session / AsyncClient 的类型化 Send 发送
+template <typename T>
+concept TypedMsg = msg_schema_detail::HasFields<T>::value && requires{
+    { T::MSG_ID } -> std::convertible_to<std::uint16_t>;
+};
+
+// 编码到 out，out 至少要有 MsgWireSize<T> 字节
+template <typename T>
+inline void EncodeMsg(const T& msg, char* out){
+    msg_schema_detail::EncodeField(msg, out);
+}
+
+// 从 in 解码，length 必须恰好等于 MsgWireSize<T>，否则返回 false 且不修改 msg
+template <typename T>
+inline bool DecodeMsg(const char* in, std::size_t length, T& msg){
+    if(length != MsgWireSize<T>){
+        return false;
+    }
+    msg_schema_detail::DecodeField(msg, in);
+    return true;
+}
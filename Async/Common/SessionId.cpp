@@ -0,0 +1,56 @@
+#include "SessionId.h"
+#include <atomic>
+#include <cstdio>
+#include <random>
+
+namespace{
+
+std::atomic<std::uint16_t> g_node_id{0};
+std::atomic<std::uint32_t> g_next_thread{0};
+
+// 每个线程的ID前缀（node + thread）和序号；序号从 1 开始，保证ID不为 0
+struct ThreadState{
+    std::uint64_t prefix;
+    std::uint64_t sequence = 0;
+
+    ThreadState(){
+        // 线程编号只有 8 位，超过 256 个线程时回绕；序号有 40 位，单个线程约一万亿个ID后才会回绕
+        std::uint64_t thread_no = g_next_thread.fetch_add(1, std::memory_order_relaxed) & ((1u << SessionId::THREAD_BITS) - 1);
+        prefix = (static_cast<std::uint64_t>(g_node_id.load(std::memory_order_relaxed)) << (SessionId::THREAD_BITS + SessionId::SEQUENCE_BITS))
+            | (thread_no << SessionId::SEQUENCE_BITS);
+    }
+};
+
+thread_local ThreadState t_state;
+
+// 进程级随机数，第一次格式化 UUID 时才生成
+std::uint64_t ProcessSalt(){
+    static const std::uint64_t salt = [](){
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    }();
+    return salt;
+}
+
+} // namespace
+
+std::uint64_t SessionId::Next(){
+    std::uint64_t sequence = ++t_state.sequence & ((1ull << SEQUENCE_BITS) - 1);
+    if(sequence == 0){
+        sequence = ++t_state.sequence & ((1ull << SEQUENCE_BITS) - 1);
+    }
+    return t_state.prefix | sequence;
+}
+
+void SessionId::SetNodeId(std::uint16_t node_id){
+    g_node_id.store(node_id, std::memory_order_relaxed);
+}
+
+std::string SessionId::ToUuid(std::uint64_t session_id){
+    std::uint64_t high = ProcessSalt();
+    char text[37];
+    std::snprintf(text, sizeof(text), "%08x-%04x-%04x-%04x-%012llx",
+        static_cast<unsigned>(high >> 32), static_cast<unsigned>((high >> 16) & 0xffff), static_cast<unsigned>(high & 0xffff),
+        static_cast<unsigned>(session_id >> 48), static_cast<unsigned long long>(session_id & 0xffffffffffffull));
+    return text;
+}
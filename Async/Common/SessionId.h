@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// SessionId: 会话ID生成
+// 会话ID是一个 64 位整数，布局为：
+// +----------------+-----------+------------------------------+
+// | node (16 bits) | thread(8) |      sequence (40 bits)      |
+// +----------------+-----------+------------------------------+
+// 1. 每个线程首次生成ID时领取一个线程编号，之后只递增线程本地的序号，不加锁、不访问系统熵源。
+// 2. node 用于区分同一集群中的不同进程，由 SetNodeId 在启动时设置。
+// 3. 需要文本形式的 UUID 时才调用 ToUuid 格式化，高 64 位是进程内只生成一次的随机数，
+//    保证不同进程（或重启前后）的 UUID 不重复。
+class SessionId{
+public:
+    // 生成一个新的会话ID（不为 0），可在任意线程调用
+    static std::uint64_t Next();
+
+    // 设置节点号，需在任何线程生成ID之前调用
+    static void SetNodeId(std::uint16_t node_id);
+
+    // 把会话ID格式化为 UUID 文本（xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx）
+    static std::string ToUuid(std::uint64_t session_id);
+
+    // 从会话ID中取出各个字段
+    static std::uint16_t NodeOf(std::uint64_t session_id){
+        return static_cast<std::uint16_t>(session_id >> (THREAD_BITS + SEQUENCE_BITS));
+    }
+    static std::uint8_t ThreadOf(std::uint64_t session_id){
+        return static_cast<std::uint8_t>(session_id >> SEQUENCE_BITS);
+    }
+
+    enum{NODE_BITS = 16, THREAD_BITS = 8, SEQUENCE_BITS = 40};
+};
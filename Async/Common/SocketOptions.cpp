@@ -0,0 +1,57 @@
+#include "SocketOptions.h"
+#include "Logger.h"
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+namespace{
+
+template <typename Socket, typename Option>
+void SetOption(Socket& socket, const Option& option, const char* name){
+    boost::system::error_code ec;
+    socket.set_option(option, ec);
+    if(ec){
+        LOG_WARN("Failed to set ", name, ": ", ec.message());
+    }
+}
+
+template <typename Socket>
+void SetBuffers(Socket& socket, const SocketOptions& options){
+    if(options.recv_buffer > 0){
+        SetOption(socket, boost::asio::socket_base::receive_buffer_size(options.recv_buffer), "SO_RCVBUF");
+    }
+    if(options.send_buffer > 0){
+        SetOption(socket, boost::asio::socket_base::send_buffer_size(options.send_buffer), "SO_SNDBUF");
+    }
+}
+
+} // namespace
+
+void SocketOptions::ApplyTo(tcp::acceptor& acceptor) const{
+    //接受到的连接继承监听套接字的缓冲区大小
+    SetBuffers(acceptor, *this);
+}
+
+void SocketOptions::ApplyTo(tcp::socket& socket) const{
+    if(no_delay){
+        SetOption(socket, tcp::no_delay(true), "TCP_NODELAY");
+    }
+    SetBuffers(socket, *this);
+#ifdef TCP_QUICKACK
+    if(quick_ack){
+        SetOption(socket, boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK>(true), "TCP_QUICKACK");
+    }
+#endif
+    if(keep_alive){
+        SetOption(socket, boost::asio::socket_base::keep_alive(true), "SO_KEEPALIVE");
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+        SetOption(socket, boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPIDLE>(keep_alive_idle), "TCP_KEEPIDLE");
+        SetOption(socket, boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPINTVL>(keep_alive_interval), "TCP_KEEPINTVL");
+        SetOption(socket, boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPCNT>(keep_alive_count), "TCP_KEEPCNT");
+#endif
+    }
+}
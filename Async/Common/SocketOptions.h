@@ -0,0 +1,35 @@
+#pragma once
+#include <boost/asio.hpp>
+
+// SocketOptions: 一组 TCP 套接字选项，服务器按监听器配置，客户端按连接配置
+// 1. ApplyTo(acceptor) 在 bind / listen 之前调用：收发缓冲区在监听套接字上设置，
+//    新连接从握手开始就使用这个大小（窗口扩大因子在握手时确定，连接建立后再改只能在原因子范围内调整）。
+// 2. ApplyTo(socket) 对每个已建立（或即将 connect）的套接字调用，设置其余选项。
+// 3. 设置失败只打印警告，不影响连接；平台不支持的选项（如 Windows 上的 TCP_QUICKACK）直接跳过。
+struct SocketOptions{
+    // 关闭 Nagle 算法：小消息立即发出，不等待前一个分段的 ACK。请求/应答式的小消息必须开启
+    bool no_delay = true;
+    // SO_RCVBUF / SO_SNDBUF（字节），0 表示使用系统默认值（Linux 上为自动调整）
+    int recv_buffer = 0;
+    int send_buffer = 0;
+    // listen 的 backlog，0 表示系统上限 (SOMAXCONN)
+    int listen_backlog = 0;
+    // TCP_QUICKACK（仅 Linux）：连接建立后立即确认而不是延迟确认。内核在之后的交互中可能恢复延迟确认，
+    // 它只是一个提示；对回显这类“收到即回复”的场景，ACK 本来就随回复一起发出
+    bool quick_ack = false;
+    // TCP keepalive：连接空闲 keep_alive_idle 秒后每隔 keep_alive_interval 秒探测一次，连续 keep_alive_count 次无响应则断开
+    // 应用层已有空闲超时和心跳（见 ServerConfig），keepalive 用于发现对端主机掉线、NAT 表项过期等
+    bool keep_alive = false;
+    int keep_alive_idle = 60;
+    int keep_alive_interval = 10;
+    int keep_alive_count = 5;
+
+    // 监听套接字：在 open 之后、bind 之前调用
+    void ApplyTo(boost::asio::ip::tcp::acceptor& acceptor) const;
+    // 连接套接字：accept 之后，或 open 之后 connect 之前调用
+    void ApplyTo(boost::asio::ip::tcp::socket& socket) const;
+    // listen 使用的 backlog
+    int Backlog() const{
+        return listen_backlog > 0 ? listen_backlog : boost::asio::socket_base::max_listen_connections;
+    }
+};
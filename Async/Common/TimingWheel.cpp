@@ -0,0 +1,114 @@
+#include "TimingWheel.h"
+
+TimerNode::~TimerNode(){
+    if(_wheel != nullptr){
+        _wheel->Cancel(*this);
+    }
+}
+
+TimingWheel::TimingWheel(boost::asio::io_context& ioc, std::chrono::milliseconds tick)
+    :_timer(ioc), _tick(tick.count() > 0 ? tick : std::chrono::milliseconds(1)), _slots(SLOT_COUNT){
+    for(TimerNode& head : _slots){
+        head._prev = &head;
+        head._next = &head;
+    }
+}
+
+TimingWheel::~TimingWheel(){
+    // 摘除剩余的定时器，避免节点析构时访问已销毁的链表
+    for(TimerNode& head : _slots){
+        while(head._next != &head){
+            TimerNode& node = *head._next;
+            Unlink(node);
+            node._wheel = nullptr;
+        }
+    }
+}
+
+void TimingWheel::Start(){
+    if(_running){
+        return;
+    }
+    _running = true;
+    _start = std::chrono::steady_clock::now() - _tick * _now;
+    ScheduleTick();
+}
+
+void TimingWheel::Stop(){
+    _running = false;
+    _timer.cancel();
+}
+
+void TimingWheel::Arm(TimerNode& node, std::chrono::milliseconds delay){
+    ArmTicks(node, ToTicks(delay));
+}
+
+void TimingWheel::ArmTicks(TimerNode& node, std::uint64_t ticks){
+    Cancel(node);
+    node._expire = _now + (ticks == 0 ? 1 : ticks);
+    node._wheel = this;
+    Link(_slots[node._expire & (SLOT_COUNT - 1)], node);
+    ++_size;
+}
+
+void TimingWheel::Cancel(TimerNode& node){
+    if(node._wheel == nullptr){
+        return;
+    }
+    Unlink(node);
+    node._wheel = nullptr;
+    --_size;
+}
+
+void TimingWheel::ScheduleTick(){
+    // 按起始时间计算下一个 tick 的绝对时间，回调被推迟时不会累计误差
+    _timer.expires_at(_start + _tick * (_now + 1));
+    _timer.async_wait([this](const boost::system::error_code& ec){
+        if(ec || !_running){
+            return;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - _start;
+        Advance(static_cast<std::uint64_t>(elapsed / _tick));
+        ScheduleTick();
+    });
+}
+
+void TimingWheel::Advance(std::uint64_t target){
+    // 回调可能重新挂入或摘除任意定时器，先把到期的节点移到临时链表，再逐个取出触发
+    TimerNode expired;
+    expired._prev = &expired;
+    expired._next = &expired;
+    while(_now < target){
+        ++_now;
+        TimerNode& head = _slots[_now & (SLOT_COUNT - 1)];
+        for(TimerNode* node = head._next; node != &head;){
+            TimerNode* next = node->_next;
+            if(node->_expire <= _now){
+                Unlink(*node);
+                Link(expired, *node);
+            }
+            node = next;
+        }
+        while(expired._next != &expired){
+            TimerNode& node = *expired._next;
+            Unlink(node);
+            node._wheel = nullptr;
+            --_size;
+            node.callback();
+        }
+    }
+}
+
+void TimingWheel::Link(TimerNode& head, TimerNode& node){
+    node._prev = head._prev;
+    node._next = &head;
+    head._prev->_next = &node;
+    head._prev = &node;
+}
+
+void TimingWheel::Unlink(TimerNode& node){
+    node._prev->_next = node._next;
+    node._next->_prev = node._prev;
+    node._prev = nullptr;
+    node._next = nullptr;
+}
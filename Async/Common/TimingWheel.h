@@ -0,0 +1,90 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <boost/asio.hpp>
+
+class TimingWheel;
+
+// TimerNode: 时间轮上的一个定时器，嵌入在使用者对象中（侵入式链表节点），挂入/摘除都不分配内存
+// callback 在挂入前设置一次即可，定时器到期时在时间轮所属的线程上调用。一个节点只能挂在同一个时间轮上。
+class TimerNode{
+public:
+    TimerNode() = default;
+    // 析构时仍挂着则自动摘除，节点和时间轮的销毁顺序不受限制
+    ~TimerNode();
+    TimerNode(const TimerNode&) = delete;
+    TimerNode& operator=(const TimerNode&) = delete;
+
+    // 是否已挂在时间轮上
+    bool Armed() const{
+        return _wheel != nullptr;
+    }
+
+    std::function<void()> callback;
+
+private:
+    friend class TimingWheel;
+    TimerNode* _prev = nullptr;
+    TimerNode* _next = nullptr;
+    std::uint64_t _expire = 0; // 到期的 tick
+    TimingWheel* _wheel = nullptr; // 挂在哪个时间轮上
+};
+
+// TimingWheel: 哈希时间轮
+// 设计原理：
+// 1. SLOT_COUNT 个槽位组成环，每个槽位是一个侵入式双向链表；到期 tick 为 t 的定时器挂在 t % SLOT_COUNT 号槽位上。
+//    超过一圈的定时器同样挂在对应槽位，扫描到时发现未到期就留在原处等下一圈。
+// 2. Arm / Cancel 都只是链表的挂入/摘除，O(1)；重新设置 = Cancel + Arm。
+// 3. 每个 IO 线程一个时间轮，由一个 steady_timer 每 tick 驱动一次，所有方法都只能在该线程上调用，不需要加锁。
+// 4. Now() 返回当前 tick，使用者可以用它廉价地记录“最后活动时间”，到期时再检查是否真的超时（惰性续期）。
+class TimingWheel{
+public:
+    TimingWheel(boost::asio::io_context& ioc, std::chrono::milliseconds tick);
+    ~TimingWheel();
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // 开始/停止驱动时间轮，需在所属 io_context 线程上调用（或在其运行前调用 Start）
+    void Start();
+    void Stop();
+
+    // 在 delay 之后触发 node.callback；node 已挂入时先摘除
+    void Arm(TimerNode& node, std::chrono::milliseconds delay);
+    // 以 tick 为单位设置，至少 1 个 tick
+    void ArmTicks(TimerNode& node, std::uint64_t ticks);
+    // 摘除定时器，未挂入时什么也不做
+    void Cancel(TimerNode& node);
+
+    // 当前 tick
+    std::uint64_t Now() const{
+        return _now;
+    }
+    // 把时长换算为 tick 数（向上取整）
+    std::uint64_t ToTicks(std::chrono::milliseconds duration) const{
+        return static_cast<std::uint64_t>((duration.count() + _tick.count() - 1) / _tick.count());
+    }
+    // 当前挂着的定时器数量
+    std::size_t Size() const{
+        return _size;
+    }
+
+private:
+    enum{SLOT_COUNT = 512}; // 必须是 2 的幂
+    void ScheduleTick();
+    // 推进到 target tick，依次处理经过的槽位
+    void Advance(std::uint64_t target);
+    static void Link(TimerNode& head, TimerNode& node);
+    static void Unlink(TimerNode& node);
+
+    boost::asio::steady_timer _timer;
+    std::chrono::milliseconds _tick;
+    std::chrono::steady_clock::time_point _start;
+    std::uint64_t _now = 0;
+    std::size_t _size = 0;
+    bool _running = false;
+    // 每个槽位一个哨兵节点，组成循环链表
+    std::vector<TimerNode> _slots;
+};
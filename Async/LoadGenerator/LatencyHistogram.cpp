@@ -0,0 +1,84 @@
+#include "LatencyHistogram.h"
+#include <bit>
+#include <cmath>
+
+namespace{
+// 线性区桶数：[0, 2^(SUB_BITS+1))
+constexpr std::size_t LINEAR_BUCKETS = std::size_t(1) << (LatencyHistogram::SUB_BITS + 1);
+// 每个对数段的子桶数
+constexpr std::size_t SUB_BUCKETS = std::size_t(1) << LatencyHistogram::SUB_BITS;
+}
+
+LatencyHistogram::LatencyHistogram()
+    :_buckets(BucketIndex(MAX_VALUE) + 1, 0){
+}
+
+std::size_t LatencyHistogram::BucketIndex(std::uint64_t value){
+    if(value < LINEAR_BUCKETS){
+        return static_cast<std::size_t>(value);
+    }
+    // shift >= 1：保留最高的 SUB_BITS+1 位，最高位恒为 1
+    int msb = 63 - std::countl_zero(value);
+    int shift = msb - SUB_BITS;
+    std::size_t sub = static_cast<std::size_t>(value >> shift) - SUB_BUCKETS;
+    return LINEAR_BUCKETS + (shift - 1) * SUB_BUCKETS + sub;
+}
+
+std::uint64_t LatencyHistogram::BucketUpperBound(std::size_t index){
+    if(index < LINEAR_BUCKETS){
+        return index;
+    }
+    std::size_t offset = index - LINEAR_BUCKETS;
+    int shift = static_cast<int>(offset / SUB_BUCKETS) + 1;
+    std::uint64_t sub = offset % SUB_BUCKETS + SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::uint64_t value){
+    if(value > MAX_VALUE){
+        value = MAX_VALUE;
+    }
+    ++_buckets[BucketIndex(value)];
+    ++_count;
+    _sum += value;
+    if(value < _min){
+        _min = value;
+    }
+    if(value > _max){
+        _max = value;
+    }
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other){
+    for(std::size_t i = 0; i < _buckets.size(); ++i){
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+    _sum += other._sum;
+    if(other._count > 0 && other._min < _min){
+        _min = other._min;
+    }
+    if(other._max > _max){
+        _max = other._max;
+    }
+}
+
+std::uint64_t LatencyHistogram::Percentile(double percentile) const{
+    if(_count == 0){
+        return 0;
+    }
+    // 至少覆盖 rank 个样本的最小桶
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * _count));
+    if(rank == 0){
+        rank = 1;
+    }
+    std::uint64_t seen = 0;
+    for(std::size_t i = 0; i < _buckets.size(); ++i){
+        seen += _buckets[i];
+        if(seen >= rank){
+            std::uint64_t bound = BucketUpperBound(i);
+            return bound < _max ? bound : _max;
+        }
+    }
+    return _max;
+}
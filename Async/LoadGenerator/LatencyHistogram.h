@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// LatencyHistogram: HDR 风格的对数-线性直方图
+// 设计原理：
+// 1. 小于 2^(SUB_BITS+1) 的值每个整数一个桶（线性区）。
+// 2. 更大的值按 2 的幂分段，每段再等分为 2^SUB_BITS 个子桶，相对误差不超过 1/2^SUB_BITS（约 0.8%）。
+// 3. 记录是 O(1) 的数组自增；合并是逐桶相加。超过 MAX_VALUE 的值按 MAX_VALUE 记录。
+class LatencyHistogram{
+public:
+    enum{SUB_BITS = 7};
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << 36) - 1; // 约 68 秒（单位纳秒）
+
+    LatencyHistogram();
+
+    void Record(std::uint64_t value);
+    void Merge(const LatencyHistogram& other);
+
+    std::uint64_t Count() const{ return _count; }
+    std::uint64_t Min() const{ return _count == 0 ? 0 : _min; }
+    std::uint64_t Max() const{ return _max; }
+    double Mean() const{ return _count == 0 ? 0.0 : static_cast<double>(_sum) / _count; }
+    // percentile: 0 ~ 100，返回所在桶的上界
+    std::uint64_t Percentile(double percentile) const;
+
+private:
+    static std::size_t BucketIndex(std::uint64_t value);
+    static std::uint64_t BucketUpperBound(std::size_t index);
+
+    std::vector<std::uint64_t> _buckets;
+    std::uint64_t _count = 0;
+    std::uint64_t _sum = 0;
+    std::uint64_t _min = ~std::uint64_t(0);
+    std::uint64_t _max = 0;
+};
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "../AsyncClient/AsyncClient.h"
+#include "LatencyHistogram.h"
+
+using namespace std;
+using Clock = std::chrono::steady_clock;
+
+// 压测参数
+struct Options{
+    string host = "127.0.0.1";
+    int port = 12345;
+    int connections = 10;   // 并发连接数
+    int threads = 1;        // IO 线程数
+    int duration = 10;      // 统计时长（秒）
+    int warmup = 1;         // 预热时长（秒），期间的样本不计入统计
+    int size = 64;          // 消息体字节数，至少 8 字节用于存放时间戳
+    string mode = "closed"; // closed: 收到回复再发下一条; open: 按固定速率发送; connect: 反复建连-回显-断开
+    int pipeline = 1;       // closed 模式下每个连接同时在途的请求数
+    double rate = 10000;    // open 模式下所有连接合计的发送速率（条/秒）
+    string json;            // JSON 结果输出路径，"-" 表示 stdout
+    bool no_delay = true;   // 压测连接是否开启 TCP_NODELAY
+    int compress = 0;       // 单帧压缩阈值（字节），0 表示不协商压缩
+};
+
+// 压测连接的套接字选项
+static SocketOptions MakeSocketOptions(const Options& options){
+    SocketOptions socket_options;
+    socket_options.no_delay = options.no_delay;
+    return socket_options;
+}
+
+// 每个 IO 线程一份统计数据，只在该线程上修改，结束后汇总
+struct WorkerStats{
+    LatencyHistogram histogram;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t received_bytes = 0;
+    uint64_t connect_errors = 0;
+};
+
+static std::atomic<bool> g_measuring{false}; // 是否处于统计窗口
+static std::atomic<bool> g_stopping{false};  // 压测结束，不再发送
+
+static int64_t NowNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// LoadConnection: 一个压测连接
+// 每条消息体的前 8 字节写入发送时间戳，服务器原样回显后据此计算往返延迟。
+class LoadConnection{
+public:
+    LoadConnection(boost::asio::io_context& ioc, const Options& options, WorkerStats& stats)
+        :_client(ioc, options.host, options.port, std::max<uint32_t>(64 * 1024, options.size), MakeSocketOptions(options)), _timer(ioc), _options(options), _stats(stats)
+        ,_payload(options.size, 'x'){
+        if(options.compress > 0){
+            _client.SetCompression(true, static_cast<uint32_t>(options.compress));
+        }
+        _client.SetConnectHandler([this](const boost::system::error_code& ec){
+            OnConnect(ec);
+        });
+        _client.SetMessageHandler([this](short /*msg_id*/, const char* data, size_t length){
+            OnMessage(data, length);
+        });
+    }
+
+private:
+    void OnConnect(const boost::system::error_code& ec){
+        if(ec){
+            ++_stats.connect_errors;
+            return;
+        }
+        if(_options.mode == "open"){
+            // 每个连接分摊总速率
+            _interval = std::chrono::nanoseconds(static_cast<int64_t>(1e9 * _options.connections / _options.rate));
+            _next_send = Clock::now();
+            ScheduleOpenLoop();
+        }else{
+            for(int i = 0; i < _options.pipeline; ++i){
+                SendOne(NowNs());
+            }
+        }
+    }
+
+    void OnMessage(const char* data, size_t length){
+        int64_t now = NowNs();
+        if(length < sizeof(int64_t)){
+            return;
+        }
+        int64_t sent_at = 0;
+        memcpy(&sent_at, data, sizeof(sent_at));
+        if(g_measuring.load(std::memory_order_relaxed)){
+            _stats.histogram.Record(static_cast<uint64_t>(now - sent_at));
+            ++_stats.received;
+            _stats.received_bytes += length;
+        }
+        if(_options.mode != "open" && !g_stopping.load(std::memory_order_relaxed)){
+            SendOne(now);
+        }
+    }
+
+    // 开环：按计划时间发送。时间戳使用计划发送时间而不是实际发送时间，
+    // 服务器变慢导致发送被推迟时，推迟的时间也会计入延迟（避免协调遗漏）。
+    void ScheduleOpenLoop(){
+        if(g_stopping.load(std::memory_order_relaxed)){
+            return;
+        }
+        _timer.expires_at(_next_send);
+        _timer.async_wait([this](const boost::system::error_code& ec){
+            if(ec){
+                return;
+            }
+            // 落后于计划时会连续补发，直到追上当前时间
+            auto now = Clock::now();
+            while(_next_send <= now && !g_stopping.load(std::memory_order_relaxed)){
+                SendOne(std::chrono::duration_cast<std::chrono::nanoseconds>(_next_send.time_since_epoch()).count());
+                _next_send += _interval;
+            }
+            ScheduleOpenLoop();
+        });
+    }
+
+    void SendOne(int64_t timestamp){
+        memcpy(_payload.data(), &timestamp, sizeof(timestamp));
+        // 发送队列超过上限时 Send 会丢弃消息（开环模式下服务器跟不上时可能出现），不计入已发送
+        if(_client.Send(_payload.data(), _payload.size()) && g_measuring.load(std::memory_order_relaxed)){
+            ++_stats.sent;
+        }
+    }
+
+    AsyncClient _client;
+    boost::asio::steady_timer _timer;
+    const Options& _options;
+    WorkerStats& _stats;
+    vector<char> _payload;
+    Clock::duration _interval{};
+    Clock::time_point _next_send{};
+};
+
+// ChurnConnection: 建连压测连接
+// 循环执行 连接 -> 发送一帧 -> 读回同样长度的回显 -> 关闭，测量服务器每秒能接受并服务多少个新连接。
+// 只按字节数读回显，因此对 v1/Sync 这类原样回显的服务器同样适用。
+class ChurnConnection{
+public:
+    ChurnConnection(boost::asio::io_context& ioc, const Options& options, WorkerStats& stats)
+        :_socket(ioc), _endpoint(boost::asio::ip::make_address(options.host), options.port), _stats(stats)
+        ,_frame(MSG_HEAD_LENGTH + options.size, 'x'), _reply(_frame.size()){
+        MsgHeader head;
+        head.msg_id = MSG_ECHO;
+        head.length = static_cast<uint32_t>(options.size);
+        EncodeMsgHeader(_frame.data(), head);
+        Connect();
+    }
+
+private:
+    void Connect(){
+        if(g_stopping.load(std::memory_order_relaxed)){
+            return;
+        }
+        _started_at = NowNs();
+        _socket.async_connect(_endpoint, [this](const boost::system::error_code& ec){
+            if(ec){
+                ++_stats.connect_errors;
+                Restart();
+                return;
+            }
+            // 关闭时直接发送 RST，压测端不进入 TIME_WAIT，避免耗尽本地端口
+            boost::system::error_code ignored;
+            _socket.set_option(boost::asio::socket_base::linger(true, 0), ignored);
+            boost::asio::async_write(_socket, boost::asio::buffer(_frame),
+                [this](const boost::system::error_code& ec, size_t){
+                    if(ec){
+                        Restart();
+                        return;
+                    }
+                    boost::asio::async_read(_socket, boost::asio::buffer(_reply),
+                        [this](const boost::system::error_code& ec, size_t length){
+                            if(!ec && g_measuring.load(std::memory_order_relaxed)){
+                                _stats.histogram.Record(static_cast<uint64_t>(NowNs() - _started_at));
+                                ++_stats.sent;
+                                ++_stats.received;
+                                _stats.received_bytes += length;
+                            }
+                            Restart();
+                        });
+                });
+        });
+    }
+
+    void Restart(){
+        boost::system::error_code ignored;
+        _socket.close(ignored);
+        Connect();
+    }
+
+    boost::asio::ip::tcp::socket _socket;
+    boost::asio::ip::tcp::endpoint _endpoint;
+    WorkerStats& _stats;
+    vector<char> _frame;
+    vector<char> _reply;
+    int64_t _started_at = 0;
+};
+
+static void PrintUsage(){
+    cout << "Usage: LoadGenerator [--host 127.0.0.1] [--port 12345] [--connections 10] [--threads 1]\n"
+         << "                     [--duration 10] [--warmup 1] [--size 64]\n"
+         << "                     [--mode closed|open|connect] [--pipeline 1] [--rate 10000] [--json out.json|-]\n"
+         << "                     [--nodelay 1|0] [--compress 0]\n";
+}
+
+static bool ParseOptions(int argc, char* argv[], Options& options){
+    for(int i = 1; i < argc; ++i){
+        string key = argv[i];
+        if(key == "--help" || key == "-h" || i + 1 >= argc){
+            return false;
+        }
+        string value = argv[++i];
+        if(key == "--host") options.host = value;
+        else if(key == "--port") options.port = atoi(value.c_str());
+        else if(key == "--connections") options.connections = atoi(value.c_str());
+        else if(key == "--threads") options.threads = atoi(value.c_str());
+        else if(key == "--duration") options.duration = atoi(value.c_str());
+        else if(key == "--warmup") options.warmup = atoi(value.c_str());
+        else if(key == "--size") options.size = atoi(value.c_str());
+        else if(key == "--mode") options.mode = value;
+        else if(key == "--pipeline") options.pipeline = atoi(value.c_str());
+        else if(key == "--rate") options.rate = atof(value.c_str());
+        else if(key == "--json") options.json = value;
+        else if(key == "--nodelay") options.no_delay = atoi(value.c_str()) != 0;
+        else if(key == "--compress") options.compress = atoi(value.c_str());
+        else return false;
+    }
+    if(options.size < static_cast<int>(sizeof(int64_t)) || options.connections <= 0 || options.threads <= 0
+        || options.duration <= 0 || options.pipeline <= 0 || options.rate <= 0
+        || (options.mode != "closed" && options.mode != "open" && options.mode != "connect")){
+        return false;
+    }
+    return true;
+}
+
+static string ToJson(const Options& options, const WorkerStats& total, double seconds){
+    const LatencyHistogram& h = total.histogram;
+    ostringstream out;
+    out << "{\n"
+        << "  \"target\": \"" << options.host << ":" << options.port << "\",\n"
+        << "  \"mode\": \"" << options.mode << "\",\n"
+        << "  \"connections\": " << options.connections << ",\n"
+        << "  \"threads\": " << options.threads << ",\n"
+        << "  \"payload_size\": " << options.size << ",\n"
+        << "  \"pipeline\": " << options.pipeline << ",\n"
+        << "  \"target_rate\": " << (options.mode == "open" ? options.rate : 0) << ",\n"
+        << "  \"duration_s\": " << seconds << ",\n"
+        << "  \"sent\": " << total.sent << ",\n"
+        << "  \"received\": " << total.received << ",\n"
+        << "  \"connect_errors\": " << total.connect_errors << ",\n"
+        << "  \"throughput_msgs_per_s\": " << total.received / seconds << ",\n"
+        << "  \"throughput_mb_per_s\": " << total.received_bytes / seconds / (1024 * 1024) << ",\n"
+        << "  \"latency_ns\": {\"min\": " << h.Min() << ", \"mean\": " << static_cast<uint64_t>(h.Mean())
+        << ", \"p50\": " << h.Percentile(50) << ", \"p90\": " << h.Percentile(90)
+        << ", \"p99\": " << h.Percentile(99) << ", \"p999\": " << h.Percentile(99.9)
+        << ", \"max\": " << h.Max() << "}\n"
+        << "}\n";
+    return out.str();
+}
+
+static void PrintText(const Options& options, const WorkerStats& total, double seconds){
+    const LatencyHistogram& h = total.histogram;
+    auto us = [](uint64_t ns){ return ns / 1000.0; };
+    // connect 模式下每次建连只回显一条消息，吞吐即每秒完成的连接数，延迟为建连到收到回显的时间
+    const char* unit = options.mode == "connect" ? " conn/s, " : " msg/s, ";
+    cout << "target      : " << options.host << ":" << options.port << " (" << options.mode << " loop)\n"
+         << "connections : " << options.connections << " on " << options.threads << " thread(s), payload "
+         << options.size << " bytes\n"
+         << "sent/recv   : " << total.sent << " / " << total.received
+         << " (connect errors " << total.connect_errors << ")\n"
+         << "throughput  : " << total.received / seconds << unit
+         << total.received_bytes / seconds / (1024 * 1024) << " MB/s\n"
+         << "latency(us) : min " << us(h.Min()) << "  mean " << us(static_cast<uint64_t>(h.Mean()))
+         << "  p50 " << us(h.Percentile(50)) << "  p99 " << us(h.Percentile(99))
+         << "  p99.9 " << us(h.Percentile(99.9)) << "  max " << us(h.Max()) << endl;
+}
+
+int main(int argc, char* argv[]){
+    Options options;
+    if(!ParseOptions(argc, argv, options)){
+        PrintUsage();
+        return 1;
+    }
+
+    try{
+        // 每个 IO 线程一个 io_context 和一份统计数据
+        vector<unique_ptr<boost::asio::io_context>> contexts;
+        vector<unique_ptr<WorkerStats>> stats;
+        for(int i = 0; i < options.threads; ++i){
+            contexts.emplace_back(make_unique<boost::asio::io_context>(1));
+            stats.emplace_back(make_unique<WorkerStats>());
+        }
+
+        vector<unique_ptr<LoadConnection>> connections;
+        vector<unique_ptr<ChurnConnection>> churns;
+        for(int i = 0; i < options.connections; ++i){
+            int worker = i % options.threads;
+            if(options.mode == "connect"){
+                churns.emplace_back(make_unique<ChurnConnection>(*contexts[worker], options, *stats[worker]));
+            }else{
+                connections.emplace_back(make_unique<LoadConnection>(*contexts[worker], options, *stats[worker]));
+            }
+        }
+
+        vector<thread> threads;
+        for(auto& ioc : contexts){
+            threads.emplace_back([&ioc](){
+                auto work = boost::asio::make_work_guard(*ioc);
+                ioc->run();
+            });
+        }
+
+        this_thread::sleep_for(chrono::seconds(options.warmup));
+        auto begin = Clock::now();
+        g_measuring = true;
+        this_thread::sleep_for(chrono::seconds(options.duration));
+        g_measuring = false;
+        double seconds = chrono::duration<double>(Clock::now() - begin).count();
+        g_stopping = true;
+
+        for(auto& ioc : contexts){
+            ioc->stop();
+        }
+        for(auto& t : threads){
+            t.join();
+        }
+
+        WorkerStats total;
+        for(auto& s : stats){
+            total.histogram.Merge(s->histogram);
+            total.sent += s->sent;
+            total.received += s->received;
+            total.received_bytes += s->received_bytes;
+            total.connect_errors += s->connect_errors;
+        }
+
+        PrintText(options, total, seconds);
+        if(options.json == "-"){
+            cout << ToJson(options, total, seconds);
+        }else if(!options.json.empty()){
+            ofstream(options.json) << ToJson(options, total, seconds);
+        }
+
+        // 连接对象持有 io_context 上的 socket 和定时器，需先于 io_context 销毁
+        connections.clear();
+        churns.clear();
+    }catch(std::exception& e){
+        std::cerr << "Exception: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
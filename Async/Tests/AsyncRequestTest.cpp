@@ -0,0 +1,136 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <boost/asio.hpp>
+#include "../AsyncClient/AsyncClient.h"
+#include "../AsyncClient/AsyncClientPool.h"
+#include "../Common/Messages.h"
+
+using namespace std;
+using boost::asio::awaitable;
+using boost::asio::use_awaitable;
+
+// AsyncRequest 配合 use_awaitable 的回归测试：延迟令牌在 co_await 时才启动操作，
+// 这里先创建操作、改写或销毁请求数据，再 co_await，回复必须是创建操作时的内容。
+// 需要一个运行中的 v2 服务器（回显 MSG_ECHO / MSG_POSITION，应答 MSG_BROADCAST 请求），用法：
+//   AsyncRequestTest [host] [port]
+
+static int g_failures = 0;
+
+static void Check(bool ok, const string& name) {
+    cout << (ok ? "[ OK ] " : "[FAIL] ") << name << endl;
+    if (!ok) {
+        ++g_failures;
+    }
+}
+
+static string ToString(const RpcReply& reply) {
+    return string(reply.data.begin(), reply.data.end());
+}
+
+// 创建操作后改写缓冲区再 co_await
+awaitable<void> TestRawBuffer(AsyncClient& client) {
+    string body = "awaitable-request";
+    auto op = client.AsyncRequest(body.data(), body.size(), MSG_ECHO, std::chrono::milliseconds(1000), use_awaitable);
+    string expected = body;
+    body.assign(body.size(), '#');
+    body.clear();
+    body.shrink_to_fit();
+    RpcReply reply = co_await std::move(op);
+    Check(reply.msg_id == MSG_ECHO && ToString(reply) == expected, "raw buffer released before co_await");
+}
+
+// 类型化重载在栈上的 std::array 里编码，AsyncRequest 返回时它已经销毁
+awaitable<void> TestTypedMsg(AsyncClient& client) {
+    PositionMsg msg;
+    msg.entity_id = 0x1122334455667788ULL;
+    msg.seq = 7;
+    msg.x = 1.5f;
+    msg.y = -2.25f;
+    msg.yaw = 9000;
+    auto op = client.AsyncRequest(msg, std::chrono::milliseconds(1000), use_awaitable);
+    // 覆盖刚才那块栈空间
+    volatile char scratch[256];
+    for (size_t i = 0; i < sizeof(scratch); ++i) {
+        scratch[i] = static_cast<char>(0xEE);
+    }
+    RpcReply reply = co_await std::move(op);
+    PositionMsg back;
+    bool decoded = DecodeMsg(reply.data.data(), reply.data.size(), back);
+    Check(decoded && back.entity_id == msg.entity_id && back.seq == msg.seq && back.x == msg.x && back.y == msg.y
+        && back.yaw == msg.yaw, "typed message encoded before co_await");
+}
+
+// 多个操作先全部创建，再依次 co_await
+awaitable<void> TestManyDeferred(AsyncClient& client) {
+    vector<decltype(client.AsyncRequest(nullptr, 0, MSG_ECHO, std::chrono::milliseconds(0), use_awaitable))> ops;
+    for (int i = 0; i < 32; ++i) {
+        string body = "deferred-" + to_string(i);
+        ops.push_back(client.AsyncRequest(body.data(), body.size(), MSG_ECHO, std::chrono::milliseconds(1000), use_awaitable));
+    }
+    bool ok = true;
+    for (int i = 0; i < 32; ++i) {
+        RpcReply reply = co_await std::move(ops[i]);
+        ok = ok && ToString(reply) == "deferred-" + to_string(i);
+    }
+    Check(ok, "32 deferred requests");
+}
+
+// 没有处理函数的消息ID：以 timed_out 异常结束
+awaitable<void> TestTimeout(AsyncClient& client) {
+    boost::system::error_code ec;
+    try {
+        co_await client.AsyncRequest("x", 1, 1500, std::chrono::milliseconds(200), use_awaitable);
+    }
+    catch (const boost::system::system_error& e) {
+        ec = e.code();
+    }
+    Check(ec == boost::asio::error::timed_out, "timeout surfaces as exception");
+}
+
+// 连接池转发到被选中的连接，同样要求立即封包
+awaitable<void> TestPool(AsyncClientPool& pool) {
+    string body = "pool-awaitable";
+    auto op = pool.AsyncRequest(body.data(), body.size(), MSG_ECHO, std::chrono::milliseconds(1000), use_awaitable);
+    string expected = body;
+    body.assign(body.size(), '#');
+    RpcReply reply = co_await std::move(op);
+    Check(ToString(reply) == expected, "pool request released before co_await");
+}
+
+awaitable<void> RunAll(AsyncClient& client, AsyncClientPool& pool) {
+    co_await TestRawBuffer(client);
+    co_await TestTypedMsg(client);
+    co_await TestManyDeferred(client);
+    co_await TestTimeout(client);
+    co_await TestPool(pool);
+}
+
+int main(int argc, char* argv[]) {
+    string host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? atoi(argv[2]) : 12345;
+
+    boost::asio::io_context ioc;
+    auto work = boost::asio::make_work_guard(ioc);
+    AsyncClient client(ioc, host, port);
+    AsyncClientPool pool(ioc, {AsyncClientPool::Endpoint{host, port}}, 2);
+    thread io_thread([&ioc]() {
+        ioc.run();
+    });
+    // 请求在连接建立前就可以发起，帧在连接成功后发出
+    auto done = boost::asio::co_spawn(ioc, RunAll(client, pool), boost::asio::use_future);
+    try {
+        done.get();
+    }
+    catch (const std::exception& e) {
+        cout << "[FAIL] exception: " << e.what() << endl;
+        ++g_failures;
+    }
+    client.Close();
+    pool.Close();
+    work.reset();
+    io_thread.join();
+
+    cout << (g_failures == 0 ? "all passed" : to_string(g_failures) + " failed") << endl;
+    return g_failures == 0 ? 0 : 1;
+}
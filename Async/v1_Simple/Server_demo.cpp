@@ -18,13 +18,13 @@ void Server::StartAccept(){
 void Server::HandleAccept(shared_ptr<Session> new_session, const boost::system::error_code& error){
     if(!error){
         new_session->Start();
-        _sessions.insert(make_pair(new_session->GetUuid(), new_session));
+        _sessions.insert(make_pair(new_session->GetSessionId(), new_session));
     }else{
         //delete new_session;
     }
     StartAccept();
 }   
 
-void Server::ClearSession(std::string uuid){
-    _sessions.erase(uuid);
+void Server::ClearSession(std::uint64_t session_id){
+    _sessions.erase(session_id);
 }
@@ -2,14 +2,14 @@
 #include <iostream>
 #include <map>
 #include <memory>
-#include <string>
+#include <cstdint>
 using namespace std;
 
 class Server{
 public:
     //构造函数，初始化io_context和acceptor，并开始接受连接
     Server(boost::asio::io_context& ioc, short  port);
-    void ClearSession(std::string uuid);
+    void ClearSession(std::uint64_t session_id);
 private:
     //开始接受连接
     void StartAccept();
@@ -20,5 +20,5 @@ private:
     //acceptor用于监听传入连接
     tcp::acceptor _acceptor;
 
-    std::map<std::string, shared_ptr<Session>> _sessions;
+    std::map<std::uint64_t, shared_ptr<Session>> _sessions;
 };
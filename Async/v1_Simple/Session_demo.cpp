@@ -10,10 +10,6 @@ void Session::Start(){
         std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, shared_from_this()));
 }
 
-std::string& Session::GetUuid(){
-    return _uuid;
-}
-
 // v1 版本：半双工模式 (Half-Duplex)
 // 读 -> 写 -> 读 -> 写
 // 缺点：
@@ -35,7 +31,7 @@ void Session::HandleRead(const boost::system::error_code& error,
             std::bind(&Session::HandleWrite, this, placeholders::_1, _self_shared));
     }else{
         cerr << "Read error: " << error.message() << endl;
-        _server->ClearSession(_uuid);
+        _server->ClearSession(_session_id);
     }
 }
 
@@ -50,6 +46,6 @@ void Session::HandleWrite(const boost::system::error_code& error,
 
     }else{
         cerr << "Write error: " << error.message() << endl;
-        _server->ClearSession(_uuid);
+        _server->ClearSession(_session_id);
     }
 }
@@ -5,8 +5,7 @@
 #include <climits>
 #include <iostream>
 #include <boost/asio.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
+#include "../Common/SessionId.h"
 
 using namespace std;
 using boost::asio::ip::tcp;
@@ -15,9 +14,7 @@ class Server;
 
 class Session:public enable_shared_from_this<Session>{
 public:
-    Session(boost::asio::io_context& ioc, Server* server):_socket(ioc), _server(server){
-        boost::uuids::uuid a_uuid = boost::uuids::random_generator()();
-        _uuid = boost::uuids::to_string(a_uuid);
+    Session(boost::asio::io_context& ioc, Server* server):_socket(ioc), _server(server), _session_id(SessionId::Next()){
     }
 
     tcp::socket& Socket(){
@@ -26,7 +23,14 @@ public:
 
     void Start();
 
-    std::string& GetUuid();
+    std::uint64_t GetSessionId() const{
+        return _session_id;
+    }
+
+    // UUID 文本由会话ID按需格式化
+    std::string GetUuid() const{
+        return SessionId::ToUuid(_session_id);
+    }
 
 private:
     void HandleRead(const boost::system::error_code& error, size_t bytes_transferred, shared_ptr<Session> _self_shared);
@@ -36,5 +40,5 @@ private:
     enum{max_length = 1024};
     char _data[max_length]; // v1 使用简单的 _data 缓冲区
     Server* _server;
-    std::string _uuid;
+    std::uint64_t _session_id;
 };
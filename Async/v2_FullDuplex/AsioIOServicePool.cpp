@@ -0,0 +1,82 @@
+#include "AsioIOServicePool.h"
+#include "../Common/Logger.h"
+using namespace std;
+
+AsioIOServicePool::AsioIOServicePool(std::size_t size, Policy policy)
+    :_loads(new std::atomic<std::size_t>[size == 0 ? 1 : size]), _nextIOService(0), _policy(policy){
+    if(size == 0){
+        size = 1; // hardware_concurrency() 可能返回 0
+    }
+
+    for(std::size_t i = 0; i < size; ++i){
+        _ioServices.emplace_back(std::make_unique<IOService>(1)); // 并发提示为1：每个 io_context 只有一个线程
+        _works.emplace_back(std::make_unique<Work>(_ioServices[i]->get_executor()));
+        _loads[i].store(0);
+    }
+
+    // 每个 io_context 一个线程
+    for(std::size_t i = 0; i < size; ++i){
+        _threads.emplace_back([this, i](){
+            _ioServices[i]->run();
+        });
+    }
+    LOG_INFO("IO service pool started with ", size, " threads");
+}
+
+AsioIOServicePool::~AsioIOServicePool(){
+    Stop();
+}
+
+std::size_t AsioIOServicePool::NextIndex(){
+    if(_policy == Policy::LEAST_LOAD){
+        std::size_t best = 0;
+        std::size_t best_load = _loads[0].load(std::memory_order_relaxed);
+        for(std::size_t i = 1; i < _ioServices.size(); ++i){
+            std::size_t load = _loads[i].load(std::memory_order_relaxed);
+            if(load < best_load){
+                best = i;
+                best_load = load;
+            }
+        }
+        return best;
+    }
+    return _nextIOService.fetch_add(1, std::memory_order_relaxed) % _ioServices.size();
+}
+
+AsioIOServicePool::IOService& AsioIOServicePool::GetIOService(std::size_t index){
+    return *_ioServices[index];
+}
+
+std::size_t AsioIOServicePool::Size() const{
+    return _ioServices.size();
+}
+
+void AsioIOServicePool::AddLoad(std::size_t index){
+    _loads[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsioIOServicePool::SubLoad(std::size_t index){
+    _loads[index].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AsioIOServicePool::Stop(){
+    if(_stopped){
+        return;
+    }
+    _stopped = true;
+
+    // 释放 work 后立即 stop，不等待队列排空：时间轮的定时器、io_uring 的 eventfd 等待一直挂着，
+    // io_context 永远不会自己变空。尚未执行的处理函数被丢弃，所以调用前应先由 Server::Shutdown
+    // 让会话写完回复并关闭（见 AsyncServer.cpp）
+    for(auto& work : _works){
+        work->reset();
+    }
+    for(auto& ioc : _ioServices){
+        ioc->stop();
+    }
+    for(auto& t : _threads){
+        if(t.joinable()){
+            t.join();
+        }
+    }
+}
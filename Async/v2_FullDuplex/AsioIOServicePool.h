@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+
+using namespace std;
+
+// AsioIOServicePool: 多 io_context 线程池
+// 设计原理：
+// 1. 每个线程独占一个 io_context，Session 的所有回调都在所属线程上串行执行，无需 strand。
+// 2. 新连接按 轮询(RoundRobin) 或 最少负载(LeastLoad) 分配到某个 io_context 上，充分利用多核。
+// 3. 通过 executor_work_guard 防止 io_context 在没有任务时提前退出 run()。
+class AsioIOServicePool{
+public:
+    using IOService = boost::asio::io_context;
+    using Work = boost::asio::executor_work_guard<IOService::executor_type>;
+    using WorkPtr = std::unique_ptr<Work>;
+
+    // 连接分配策略
+    enum class Policy{
+        ROUND_ROBIN, // 依次轮询
+        LEAST_LOAD   // 选择当前会话数最少的 io_context
+    };
+
+    // size: io_context 数量（即 IO 线程数），为 0 时按 CPU 核数
+    AsioIOServicePool(std::size_t size = std::thread::hardware_concurrency(), Policy policy = Policy::ROUND_ROBIN);
+    ~AsioIOServicePool();
+
+    AsioIOServicePool(const AsioIOServicePool&) = delete;
+    AsioIOServicePool& operator=(const AsioIOServicePool&) = delete;
+
+    // 按分配策略挑选一个 io_context，返回其下标
+    std::size_t NextIndex();
+    // 根据下标获取 io_context
+    IOService& GetIOService(std::size_t index);
+    // io_context 数量
+    std::size_t Size() const;
+
+    // 会话数统计，用于 LEAST_LOAD 策略
+    void AddLoad(std::size_t index);
+    void SubLoad(std::size_t index);
+
+    // 停止所有 io_context 并等待线程退出；队列中尚未执行的处理函数被丢弃，不会排空
+    void Stop();
+
+private:
+    std::vector<std::unique_ptr<IOService>> _ioServices;
+    std::vector<WorkPtr> _works;
+    std::vector<std::thread> _threads;
+    // 每个 io_context 上的活跃会话数
+    std::unique_ptr<std::atomic<std::size_t>[]> _loads;
+    std::atomic<std::size_t> _nextIOService;
+    Policy _policy;
+    bool _stopped = false;
+};
@@ -1,13 +1,63 @@
+#include <cstdlib>
 #include <iostream>
 #include <boost/asio.hpp>
 #include "Session_demo.h"
 #include "Server_demo.h"
+#include "AsioIOServicePool.h"
+#include "LogicSystem.h"
 
-int main(){
+// 用法: AsyncServer [IO线程数] [最大帧长度] [epoll|uring] [single|reuseport]
+// IO线程数缺省为 CPU 核数，传 1 即退化为单 io_context 模式
+// 最大帧长度缺省见 ServerConfig
+// 第三个参数选择读写后端，缺省为 epoll（Boost.Asio 的 reactor）；uring 在内核不支持时自动退回 epoll
+// 第四个参数选择接受连接的方式，缺省为 single；reuseport 时每个 IO 线程一个 SO_REUSEPORT acceptor
+// Ctrl+C 或 kill (SIGTERM) 优雅关闭：停止接受连接、写完已收到请求的回复后关闭连接，再退出
+int main(int argc, char* argv[]){
     try{
+        std::size_t io_threads = std::thread::hardware_concurrency();
+        if(argc > 1){
+            io_threads = static_cast<std::size_t>(std::atoi(argv[1]));
+        }
+        ServerConfig config;
+        if(argc > 2){
+            config.max_frame_size = static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10));
+        }
+        if(argc > 3 && std::string(argv[3]) == "uring"){
+            config.io_backend = IoBackend::IO_URING;
+        }
+        if(argc > 4 && std::string(argv[4]) == "reuseport"){
+            config.accept_mode = AcceptMode::REUSE_PORT;
+        }
+        AsioIOServicePool pool(io_threads);
+
+        //主 io_context 只负责 accept，会话分配到 pool 中运行
         boost::asio::io_context io_context;
-        Server server(io_context, 12345);
+        Server server(io_context, pool, config);
+
+        //SIGINT/SIGTERM 触发优雅关闭；关闭过程中再次收到信号则立即退出
+        boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
+        signals.async_wait([&](const boost::system::error_code& error, int signal_number){
+            if(error){
+                return;
+            }
+            LOG_INFO("Received signal ", signal_number, ", shutting down");
+            server.Shutdown([&](){
+                signals.cancel();
+                io_context.stop();
+            });
+            signals.async_wait([&](const boost::system::error_code& error, int /*signal_number*/){
+                if(!error){
+                    LOG_WARN("Received signal again, exiting without draining");
+                    io_context.stop();
+                }
+            });
+        });
         io_context.run();
+
+        //逻辑线程先处理完剩余的消息，再停止并等待 IO 线程退出
+        LogicSystem::GetInstance().Stop();
+        pool.Stop();
+        LOG_INFO("Server stopped");
     }catch(std::exception& e){
         std::cerr << "Exception: " << e.what() << std::endl;
     }
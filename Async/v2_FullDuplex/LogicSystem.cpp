@@ -0,0 +1,166 @@
+#include "LogicSystem.h"
+#include "Session_demo.h"
+#include "Server_demo.h"
+#include "../Common/Logger.h"
+#include "../Common/Metrics.h"
+#include "../Common/Messages.h"
+using namespace std;
+
+namespace{
+
+// 回显：以相同的消息ID原样发回给发送方，请求则作为回复发回
+void OnEcho(const MsgContext& ctx, short msg_id, const char* data, int length){
+    LOG_DEBUG("Received data: ", std::string_view(data, length));
+    ctx.session->Reply(ctx.request_id, data, length, msg_id);
+}
+
+// 广播：转发给所有在线会话；作为请求发来时再给发送方回一个空消息体的确认
+void OnBroadcast(const MsgContext& ctx, short msg_id, const char* data, int length){
+    [[maybe_unused]] std::size_t count = ctx.session->GetServer()->Broadcast(data, length, msg_id);
+    LOG_DEBUG("Broadcast ", length, " bytes to ", count, " sessions");
+    if(ctx.request_id != 0){
+        ctx.session->Reply(ctx.request_id, "", 0, msg_id);
+    }
+}
+
+// 位置：解码后以类型化消息原样发回，演示 MsgSchema 的收发
+void OnPosition(const MsgContext& ctx, const PositionMsg& msg){
+    LOG_DEBUG("Position of ", msg.entity_id, ": ", msg.x, ", ", msg.y, ", ", msg.z);
+    ctx.session->Reply(ctx.request_id, msg);
+}
+
+// 内置消息的路由，编译期生成跳转表；新增内置消息在这里加一条路由
+using BuiltinDispatcher = MsgDispatcher<const MsgContext&,
+    RawRoute<MSG_ECHO, &OnEcho>,
+    RawRoute<MSG_BROADCAST, &OnBroadcast>,
+    TypedRoute<&OnPosition>>;
+
+} // namespace
+
+LogicSystem& LogicSystem::GetInstance(){
+    static LogicSystem instance;
+    return instance;
+}
+
+LogicSystem::LogicSystem(){
+    _worker_thread = std::thread(&LogicSystem::DealMsg, this);
+}
+
+LogicSystem::~LogicSystem(){
+    Stop();
+}
+
+void LogicSystem::Stop(){
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_b_stop){
+            return;
+        }
+        _b_stop = true;
+    }
+    _consume.notify_one();
+    if(_worker_thread.joinable()){
+        _worker_thread.join();
+    }
+}
+
+void LogicSystem::PostMsgToQue(vector<shared_ptr<LogicNode>>& msgs){
+    if(msgs.empty()){
+        return;
+    }
+    bool need_notify = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // 队列原本不为空说明逻辑线程正在处理或已被唤醒，无需再次通知
+        need_notify = _msg_que.empty() && _tasks.empty();
+        if(need_notify && _msg_que.capacity() < msgs.size()){
+            _msg_que.swap(msgs);
+        }else{
+            _msg_que.insert(_msg_que.end(), std::make_move_iterator(msgs.begin()), std::make_move_iterator(msgs.end()));
+        }
+    }
+    msgs.clear();
+    if(need_notify){
+        _consume.notify_one();
+    }
+}
+
+void LogicSystem::PostMsgToQue(shared_ptr<LogicNode> msg){
+    bool need_notify = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        need_notify = _msg_que.empty() && _tasks.empty();
+        _msg_que.push_back(std::move(msg));
+    }
+    if(need_notify){
+        _consume.notify_one();
+    }
+}
+
+void LogicSystem::PostTask(function<void()> task){
+    bool need_notify = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        need_notify = _msg_que.empty() && _tasks.empty();
+        _tasks.push_back(std::move(task));
+    }
+    if(need_notify){
+        _consume.notify_one();
+    }
+}
+
+const SessionRoute* LogicSystem::FindRoute(short msg_id){
+    return BuiltinDispatcher::Find(static_cast<std::uint16_t>(msg_id));
+}
+
+void LogicSystem::RegisterCallBack(short msg_id, FunCallBack callback){
+    _fun_callbacks[msg_id] = std::move(callback);
+}
+
+void LogicSystem::DealMsg(){
+    std::vector<shared_ptr<LogicNode>> batch;
+    std::vector<function<void()>> tasks;
+    for(;;){
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _consume.wait(lock, [this](){
+                return _b_stop || !_msg_que.empty() || !_tasks.empty();
+            });
+            // 停止且队列已处理完，退出
+            if(_b_stop && _msg_que.empty() && _tasks.empty()){
+                break;
+            }
+            // 一次换出整个队列，处理期间不持有锁
+            batch.swap(_msg_que);
+            tasks.swap(_tasks);
+        }
+
+        for(auto& node : batch){
+            HandleNode(node);
+        }
+        batch.clear();
+        // 任务入队前的消息一定在本批或更早的批次里，已经处理完
+        for(auto& task : tasks){
+            task();
+        }
+        tasks.clear();
+    }
+}
+
+void LogicSystem::HandleNode(const shared_ptr<LogicNode>& node){
+    if(node->_route != nullptr){
+        //静态路由：IO 线程已查好表项并校验过长度，直接调用
+        std::uint64_t start = Metrics::NowNs();
+        node->_route->handler(node->_ctx, node->_msg_id, node->_recvnode->_msg, node->_recvnode->_cur_len);
+        Metrics::Record(Metrics::HANDLER_LATENCY, Metrics::NowNs() - start);
+        return;
+    }
+    auto iter = _fun_callbacks.find(node->_msg_id);
+    if(iter == _fun_callbacks.end()){
+        LOG_WARN("msg id [", node->_msg_id, "] handler not found");
+        return;
+    }
+    std::uint64_t start = Metrics::NowNs();
+    iter->second(node->_ctx, node->_msg_id, node->_recvnode->_msg, node->_recvnode->_cur_len);
+    Metrics::Record(Metrics::HANDLER_LATENCY, Metrics::NowNs() - start);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MsgNode.h"
+#include "../Common/MsgId.h"
+#include "../Common/MsgDispatch.h"
+
+using namespace std;
+
+class Session;
+
+// MsgContext: 处理函数的调用上下文
+// 回复统一用 session->Reply(request_id, ...)：消息是请求时带上请求ID，否则等同于 Send
+struct MsgContext{
+    shared_ptr<Session> session;  // 持有会话，保证处理期间会话不被析构
+    std::uint32_t request_id = 0; // 请求ID（MSG_FLAG_REQUEST），0 表示不是请求
+};
+
+// 内置消息的分发表项（见 MsgDispatch.h），处理函数的第一个参数是调用上下文
+using SessionRoute = MsgRoute<const MsgContext&>;
+
+// LogicNode: 投递到逻辑线程的一条完整消息
+class LogicNode{
+    friend class LogicSystem;
+public:
+    LogicNode(MsgContext ctx, short msg_id, shared_ptr<MsgNode> recvnode, const SessionRoute* route = nullptr)
+        :_ctx(std::move(ctx)), _msg_id(msg_id), _recvnode(std::move(recvnode)), _route(route){}
+private:
+    MsgContext _ctx;
+    short _msg_id;
+    shared_ptr<MsgNode> _recvnode; // 消息体的拷贝（接收缓冲区只在 IO 回调期间有效）
+    const SessionRoute* _route;    // IO 线程查到的静态分发表项，nullptr 时按 _fun_callbacks 分发
+};
+
+// 消息处理函数：调用上下文、消息ID、消息体
+using FunCallBack = function<void(const MsgContext& ctx, short msg_id, const char* data, int length)>;
+
+// LogicSystem: 逻辑层单例
+// 设计原理：
+// 1. 网络层只负责收发，把完整的消息投递到逻辑队列，IO 线程不会被业务处理阻塞。
+// 2. 独立的逻辑线程从队列取出消息，按消息ID查找处理函数，处理函数通过 Session::Send 回复。
+//    内置消息的路由在 LogicSystem.cpp 中编译期生成跳转表，IO 线程投递前查好表项，逻辑线程直接调用；
+//    RegisterCallBack 注册的运行时处理函数仍按 map 查找。
+// 3. 批量交接：IO 线程一次 HandleRead 解析出的所有消息一次性入队；逻辑线程每次被唤醒时把整个队列换出来处理，
+//    加锁和唤醒的开销由一批消息分摊。
+class LogicSystem{
+public:
+    static LogicSystem& GetInstance();
+
+    // 投递一批消息，投递后 msgs 被清空（保留容量以便复用）
+    void PostMsgToQue(vector<shared_ptr<LogicNode>>& msgs);
+    // 投递单条消息
+    void PostMsgToQue(shared_ptr<LogicNode> msg);
+    // 在此前已入队的消息都处理完之后，在逻辑线程上执行 task
+    void PostTask(function<void()> task);
+    // 注册运行时消息处理函数，需在服务器启动前调用；静态分发表中已有的消息ID不会走到这里
+    void RegisterCallBack(short msg_id, FunCallBack callback);
+    // 查找内置消息的静态分发表项，未注册返回 nullptr；只读常量表，可在 IO 线程调用
+    static const SessionRoute* FindRoute(short msg_id);
+    // 停止逻辑线程，处理完已入队的消息后退出
+    void Stop();
+
+    LogicSystem(const LogicSystem&) = delete;
+    LogicSystem& operator=(const LogicSystem&) = delete;
+
+private:
+    LogicSystem();
+    ~LogicSystem();
+    // 逻辑线程主循环
+    void DealMsg();
+    // 处理一条消息
+    void HandleNode(const shared_ptr<LogicNode>& node);
+
+    std::thread _worker_thread;
+    std::vector<shared_ptr<LogicNode>> _msg_que;
+    // PostTask 投递的任务，与消息队列一起换出，在同一批消息之后执行
+    std::vector<function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _consume;
+    bool _b_stop = false;
+    // 处理函数在逻辑线程启动前注册，之后只读
+    std::map<short, FunCallBack> _fun_callbacks;
+};
@@ -1,34 +1,85 @@
 #include "MsgNode.h"
 #include <cstring>
 #include <iostream>
+#include <new>
+#include <vector>
 using namespace std;
 
-#define MAX_LENGTH 1024*2
-#define HEADE_LENGTH 2
+// 构造函数：缓冲区紧跟在对象之后，由 Create 一次性分配
+MsgNode::MsgNode(int total_len):_total_len(total_len), _cur_len(0){
+        _msg = reinterpret_cast<char*>(this + 1);
+    }
+
+std::size_t MsgNode::BlockSize(int total_len){
+        return sizeof(MsgNode) + total_len + 1;      // 多分配1字节存放'\0'
+    }
 
-// 构造函数：深拷贝数据到内部缓冲区 _msg
+// 创建发送节点：深拷贝数据到内部缓冲区 _msg
 // msg: 待发送的数据
 // total_len: 数据长度
-MsgNode::MsgNode(const char* msg, int total_len):_total_len(total_len + HEADE_LENGTH), _cur_len(0){
-        _msg = new char[_total_len + 1];             // 多分配1字节存放'\0'
-        memcpy(_msg, &total_len, HEADE_LENGTH);      // 复制消息头   
-        memcpy(_msg + HEADE_LENGTH, msg, total_len); // 复制消息体
-        _msg[_total_len] = '\0';                     // 添加字符串结束符
+// msg_id: 消息ID
+// flags: 帧头 flags
+std::shared_ptr<MsgNode> MsgNode::Create(const char* msg, int total_len, short msg_id, std::uint8_t flags){
+        auto node = CreateFrame(total_len, msg_id, flags);
+        memcpy(node->_msg + MSG_HEAD_LENGTH, msg, total_len); // 复制消息体
+        return node;
     }
 
-// 构造函数：分配指定长度的缓冲区
-// total_len: 缓冲区大小
-MsgNode::MsgNode(int total_len):_total_len(total_len + HEADE_LENGTH), _cur_len(0){
-        _msg = new char[_total_len + 1];             // 多分配1字节存放'\0'
+// 分配发送节点并写入消息头，消息体由调用方填写
+// total_len: 消息体长度
+std::shared_ptr<MsgNode> MsgNode::CreateFrame(int total_len, short msg_id, std::uint8_t flags){
+        void* block = BufferPool::Allocate(BlockSize(total_len + MSG_HEAD_LENGTH));
+        MsgNode* node = new (block) MsgNode(total_len + MSG_HEAD_LENGTH);
+        MsgHeader head;
+        head.flags = flags;
+        head.msg_id = static_cast<std::uint16_t>(msg_id);
+        head.length = static_cast<std::uint32_t>(total_len);
+        EncodeMsgHeader(node->_msg, head);                    // 写入网络字节序的消息头
+        node->_msg[node->_total_len] = '\0';              // 添加字符串结束符
+        return std::shared_ptr<MsgNode>(node, &MsgNode::Destroy, PoolAllocator<MsgNode>());
     }
 
+// 创建压缩的发送节点：先压缩到线程本地缓冲区，再按压缩后的大小分配节点，
+// 节点大小与内容一致，释放时按 _total_len 归还内存池
+std::shared_ptr<MsgNode> MsgNode::CreateCompressed(const char* msg, int total_len, short msg_id, std::uint8_t codec){
+        thread_local std::vector<char> compressed;
+        if(!Compression::Compress(codec, msg, static_cast<std::size_t>(total_len), compressed)){
+            return Create(msg, total_len, msg_id);
+        }
+        return Create(compressed.data(), static_cast<int>(compressed.size()), msg_id, codec);
+    }
 
-// 析构函数：释放内部缓冲区
-MsgNode::~MsgNode(){
-        delete[] _msg;
+// 创建回复节点：请求ID不参与压缩，压缩后没有变小时按原样发送
+std::shared_ptr<MsgNode> MsgNode::CreateReply(std::uint32_t request_id, const char* msg, int total_len, short msg_id, std::uint8_t codec){
+        thread_local std::vector<char> compressed;
+        std::uint8_t flags = MSG_FLAG_REPLY;
+        if(codec != 0 && Compression::Compress(codec, msg, static_cast<std::size_t>(total_len), compressed)){
+            msg = compressed.data();
+            total_len = static_cast<int>(compressed.size());
+            flags |= codec;
+        }
+        auto node = CreateFrame(total_len + MSG_REQUEST_ID_LENGTH, msg_id, flags);
+        EncodeRequestId(node->_msg + MSG_HEAD_LENGTH, request_id);
+        memcpy(node->_msg + MSG_HEAD_LENGTH + MSG_REQUEST_ID_LENGTH, msg, total_len);
+        return node;
+    }
+
+// 创建接收节点：分配指定长度的缓冲区
+// total_len: 缓冲区大小
+std::shared_ptr<MsgNode> MsgNode::Create(int total_len){
+        void* block = BufferPool::Allocate(BlockSize(total_len));
+        MsgNode* node = new (block) MsgNode(total_len);
+        return std::shared_ptr<MsgNode>(node, &MsgNode::Destroy, PoolAllocator<MsgNode>());
+    }
+
+// 删除器：析构节点并释放整块内存
+void MsgNode::Destroy(MsgNode* node){
+        std::size_t size = BlockSize(node->_total_len);
+        node->~MsgNode();
+        BufferPool::Deallocate(node, size);
     }
 
 void MsgNode::Clear(){
         ::memset(_msg, 0, _total_len);
         _cur_len = 0;
-    }
\ No newline at end of file
+    }
@@ -1,32 +1,72 @@
 #pragma once
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <boost/asio.hpp>
+#include "../Common/BufferPool.h"
+#include "../Common/MsgHeader.h"
+#include "../Common/Compression.h"
+#include "../Common/MsgSchema.h"
 
 using namespace std;
 
-// 前向声明 Session 类，因为它是 friend
+// 前向声明 Session、LogicSystem 类，因为它们是 friend
 class Session;
+class LogicSystem;
 
+// MsgNode: 消息节点
+// 节点对象与数据缓冲区在同一块内存中（缓冲区紧跟在对象之后），从 BufferPool 分配，
+// shared_ptr 的控制块同样从 BufferPool 分配，因此收发一条消息不再调用系统分配器。
 class MsgNode{
-    // 允许 Session 类访问私有成员
+    // 允许 Session、LogicSystem 类访问私有成员
     friend class Session;
+    friend class LogicSystem;
 public:
-    // 构造函数：深拷贝数据到内部缓冲区
+    // 创建发送节点：深拷贝数据到内部缓冲区并加上消息头（见 MsgHeader.h）
     // msg: 待发送的数据
     // total_len: 数据长度
-    MsgNode(const char* msg, int total_len);
+    // msg_id: 消息ID
+    // flags: 帧头 flags，msg 已经是压缩帧的消息体时带上对应的压缩位
+    static std::shared_ptr<MsgNode> Create(const char* msg, int total_len, short msg_id, std::uint8_t flags = MSG_FLAG_NONE);
 
-    // 构造函数：仅分配空间，用于接收数据
+    // 创建发送节点，消息体按 codec（MSG_FLAG_LZ4 / MSG_FLAG_ZLIB）压缩；压缩后没有变小时按原样发送
+    // 压缩在调用线程上进行，使用线程本地的临时缓冲区
+    static std::shared_ptr<MsgNode> CreateCompressed(const char* msg, int total_len, short msg_id, std::uint8_t codec);
+
+    // 创建回复节点：消息体前加上请求ID并设置 MSG_FLAG_REPLY，codec 不为 0 时压缩请求ID之后的部分
+    static std::shared_ptr<MsgNode> CreateReply(std::uint32_t request_id, const char* msg, int total_len, short msg_id, std::uint8_t codec);
+
+    // 创建类型化消息的发送节点：按 MsgSchema 直接编码到节点缓冲区，消息ID取 Msg::MSG_ID
+    // request_id 不为 0 时作为该请求的回复发送
+    template <TypedMsg Msg>
+    static std::shared_ptr<MsgNode> Create(const Msg& msg, std::uint32_t request_id = 0){
+        int prefix = request_id != 0 ? MSG_REQUEST_ID_LENGTH : 0;
+        auto node = CreateFrame(static_cast<int>(MsgWireSize<Msg>) + prefix, static_cast<short>(Msg::MSG_ID),
+            request_id != 0 ? MSG_FLAG_REPLY : MSG_FLAG_NONE);
+        if(request_id != 0){
+            EncodeRequestId(node->_msg + MSG_HEAD_LENGTH, request_id);
+        }
+        EncodeMsg(msg, node->_msg + MSG_HEAD_LENGTH + prefix);
+        return node;
+    }
+
+    // 创建接收节点：仅分配空间，用于存放消息体（不含消息头）
     // total_len: 缓冲区大小
-    MsgNode(int total_len);
+    static std::shared_ptr<MsgNode> Create(int total_len);
 
-    ~MsgNode();
-    
     void Clear();
 
 private:
+    MsgNode(int total_len);
+    ~MsgNode() = default;
+    // shared_ptr 的删除器：析构并把整块内存归还 BufferPool
+    static void Destroy(MsgNode* node);
+    // 节点对象 + 数据缓冲区（含结尾 '\0'）占用的总字节数
+    static std::size_t BlockSize(int total_len);
+    // 分配发送节点并写好消息头，消息体留给调用方填写
+    static std::shared_ptr<MsgNode> CreateFrame(int total_len, short msg_id, std::uint8_t flags = MSG_FLAG_NONE);
+
     int _total_len; // 消息总长度
     int _cur_len;   // 当前已发送长度
-    char* _msg;    // 消息数据缓冲区
-};
\ No newline at end of file
+    char* _msg;    // 消息数据缓冲区，指向对象之后的内存
+};
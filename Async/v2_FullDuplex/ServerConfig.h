@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "../Common/SocketOptions.h"
+
+// 发送队列超过 send_queue_limit 时对慢消费者的处理方式
+enum class SlowConsumerPolicy{
+    DROP,       // 丢弃新消息，连接保持
+    DISCONNECT  // 断开连接
+};
+
+// 会话的读写方式
+enum class IoBackend{
+    ASIO,     // Boost.Asio 的 reactor（Linux 上为 epoll），async_read_some / async_write
+    IO_URING  // 每个 IO 线程一个 io_uring，recv / sendmsg 批量提交；不可用时自动退回 ASIO
+};
+
+// 接受连接的方式
+enum class AcceptMode{
+    SINGLE,     // 主 io_context 上一个 acceptor，accept 后把会话分配给 IO 线程
+    REUSE_PORT  // 每个 IO 线程一个 SO_REUSEPORT acceptor，由内核分配连接，会话留在接受它的线程上
+};
+
+// ServerConfig: 监听器配置
+struct ServerConfig{
+    // 监听端口
+    short port = 12345;
+    // 本地管理端口（只监听 127.0.0.1），提供 /metrics 和 /metrics.json，0 表示不开启；端口被占用时只打印警告
+    unsigned short admin_port = 12346;
+    // 接受连接的方式；平台不支持 SO_REUSEPORT 时退回 SINGLE
+    AcceptMode accept_mode = AcceptMode::SINGLE;
+    // 每个 acceptor 同时挂起的 async_accept 个数：监听套接字可读时一轮就能接受多个连接
+    std::size_t pending_accepts = 1;
+    // 监听套接字和每个接受的连接使用的套接字选项（默认开启 TCP_NODELAY）
+    SocketOptions socket_options;
+    // 单帧压缩：客户端在 MSG_HELLO 中声明支持的算法后，服务器对不小于阈值的帧压缩发送
+    // compression 为 false 时协商结果总是不压缩；无论是否开启，收到的压缩帧都会解压
+    bool compression = true;
+    std::uint32_t compress_threshold = 1024;
+    // 读写后端
+    IoBackend io_backend = IoBackend::ASIO;
+    // 单帧消息体最大字节数，超过的连接会被关闭
+    std::uint32_t max_frame_size = 64 * 1024;
+
+    // 发送队列水位（字节）：排队字节数超过高水位时暂停读取该连接，回落到低水位以下后恢复
+    std::size_t send_high_water = 1024 * 1024;
+    std::size_t send_low_water = 256 * 1024;
+    // 发送队列硬上限（字节）：暂停读取后仍持续增长（如广播、SendTo）时按 slow_consumer_policy 处理
+    std::size_t send_queue_limit = 16 * 1024 * 1024;
+    SlowConsumerPolicy slow_consumer_policy = SlowConsumerPolicy::DISCONNECT;
+
+    // 连接超时，由每个 IO 线程的时间轮驱动，0 表示关闭对应检测
+    // 空闲超时：超过该时间没有收到任何数据则断开。缺省关闭，保持原来不主动断开安静连接的行为；
+    // 开启时应让客户端定期发送数据（如 MSG_HEARTBEAT），或大于客户端的心跳间隔
+    std::chrono::milliseconds idle_timeout{0};
+    // 写超时：一次写操作超过该时间仍未完成（对端长时间不读）则断开
+    std::chrono::milliseconds write_timeout{30000};
+    // 心跳间隔：超过该时间没有发送任何数据时主动发送一帧 MSG_HEARTBEAT
+    std::chrono::milliseconds heartbeat_interval{0};
+    // 时间轮精度，超时的误差不超过一个 tick
+    std::chrono::milliseconds timer_tick{100};
+
+    // 优雅关闭：等待各会话发送队列写完的最长时间，超时后直接关闭剩余连接
+    std::chrono::milliseconds shutdown_timeout{5000};
+    // 关闭开始时向每个连接发送一帧 MSG_GOODBYE
+    bool send_goodbye = true;
+};
@@ -1,30 +1,325 @@
 #include "Server_demo.h"
-#include <iostream>
+#include "../Common/Logger.h"
+#include "../Common/Metrics.h"
+#include <algorithm>
+#include <array>
 #include <boost/asio.hpp>
+#include <vector>
 using namespace std;
 
-Server::Server(boost::asio::io_context& ioc, short port):_ioc(ioc)
-    ,_acceptor(ioc, tcp::endpoint(tcp::v4(), port)){
-    cout << "Server started on port: " << port << endl;
-    StartAccept();
+Server::Server(boost::asio::io_context& ioc, AsioIOServicePool& pool, const ServerConfig& config):_ioc(ioc)
+    ,_acceptor(ioc), _pool(pool), _config(config), _shutdown_timer(ioc){
+    LOG_INFO("Server started on port: ", config.port, ", max frame size: ", config.max_frame_size);
+    //时间轮只在所属 IO 线程上访问，启动也投递到该线程执行
+    for(std::size_t index = 0; index < _pool.Size(); ++index){
+        _wheels.push_back(make_unique<TimingWheel>(_pool.GetIOService(index), _config.timer_tick));
+        boost::asio::post(_pool.GetIOService(index), [wheel = _wheels.back().get()](){
+            wheel->Start();
+        });
+    }
+    if(_config.io_backend == IoBackend::IO_URING){
+        for(std::size_t index = 0; index < _pool.Size(); ++index){
+            _urings.push_back(make_unique<IoUring>(_pool.GetIOService(index)));
+            if(!_urings.back()->Valid()){
+                //内核不支持（或被 seccomp 禁用）时所有会话统一退回 ASIO
+                LOG_WARN("io_uring unavailable, falling back to the asio backend");
+                _urings.clear();
+                _config.io_backend = IoBackend::ASIO;
+                break;
+            }
+        }
+        for(std::size_t index = 0; index < _urings.size(); ++index){
+            boost::asio::post(_pool.GetIOService(index), [uring = _urings[index].get()](){
+                uring->Start();
+            });
+        }
+        if(!_urings.empty()){
+            LOG_INFO("Using io_uring backend on ", _urings.size(), " IO threads");
+        }
+    }
+    if(_config.admin_port != 0){
+        _admin = make_unique<AdminServer>(_ioc, _config.admin_port);
+    }
+
+    if(_config.accept_mode == AcceptMode::REUSE_PORT && !OpenReusePortAcceptors()){
+        LOG_WARN("SO_REUSEPORT acceptors unavailable, falling back to a single acceptor");
+        _config.accept_mode = AcceptMode::SINGLE;
+    }
+    if(_config.accept_mode == AcceptMode::REUSE_PORT){
+        //每个 IO 线程在自己的 acceptor 上接受连接，投递到该线程上启动
+        LOG_INFO("Accepting on ", _io_acceptors.size(), " SO_REUSEPORT acceptors");
+        for(std::size_t index = 0; index < _io_acceptors.size(); ++index){
+            _accept_retries.push_back(make_unique<AcceptRetry>(_pool.GetIOService(index)));
+        }
+        for(std::size_t index = 0; index < _io_acceptors.size(); ++index){
+            boost::asio::post(_pool.GetIOService(index), [this, index](){
+                for(std::size_t i = 0; i < std::max<std::size_t>(_config.pending_accepts, 1); ++i){
+                    StartAccept(index);
+                }
+            });
+        }
+        return;
+    }
+    tcp::endpoint endpoint(tcp::v4(), _config.port);
+    _acceptor.open(endpoint.protocol());
+    _acceptor.set_option(tcp::acceptor::reuse_address(true));
+    _config.socket_options.ApplyTo(_acceptor);
+    _acceptor.bind(endpoint);
+    _acceptor.listen(_config.socket_options.Backlog());
+    _accept_retries.push_back(make_unique<AcceptRetry>(_ioc));
+    //同时挂起多个 accept，每完成一个再补一个
+    for(std::size_t i = 0; i < std::max<std::size_t>(_config.pending_accepts, 1); ++i){
+        StartAccept();
+    }
+}
+
+bool Server::OpenReusePortAcceptors(){
+#ifdef SO_REUSEPORT
+    using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+    tcp::endpoint endpoint(tcp::v4(), _config.port);
+    for(std::size_t index = 0; index < _pool.Size(); ++index){
+        auto acceptor = make_unique<tcp::acceptor>(_pool.GetIOService(index));
+        boost::system::error_code ec;
+        acceptor->open(endpoint.protocol(), ec);
+        if(!ec){
+            acceptor->set_option(tcp::acceptor::reuse_address(true), ec);
+        }
+        //同一端口上的所有 acceptor 都必须在 bind 之前设置 SO_REUSEPORT
+        if(!ec){
+            acceptor->set_option(reuse_port(true), ec);
+        }
+        if(!ec){
+            _config.socket_options.ApplyTo(*acceptor);
+            acceptor->bind(endpoint, ec);
+        }
+        if(!ec){
+            acceptor->listen(_config.socket_options.Backlog(), ec);
+        }
+        if(ec){
+            LOG_WARN("Failed to open SO_REUSEPORT acceptor ", index, ": ", ec.message());
+            _io_acceptors.clear();
+            return false;
+        }
+        _io_acceptors.push_back(std::move(acceptor));
+    }
+    return true;
+#else
+    LOG_WARN("SO_REUSEPORT is not supported on this platform");
+    return false;
+#endif
 }
 
-void Server::StartAccept(){
-    shared_ptr<Session> new_session = make_shared<Session>(_ioc, this);
+void Server::StartAccept(std::size_t index){
+    tcp::acceptor* acceptor = &_acceptor;
+    if(_io_acceptors.empty()){
+        //从线程池中挑选一个 io_context，会话的所有读写都在该线程上完成
+        index = _pool.NextIndex();
+    }else{
+        //内核已经把连接分给了这个 IO 线程的 acceptor，会话留在该线程上
+        acceptor = _io_acceptors[index].get();
+    }
+    shared_ptr<Session> new_session = make_shared<Session>(_pool.GetIOService(index), this, SessionId::Next(), index);
 
-    _acceptor.async_accept(new_session->Socket(), std::bind(&Server::HandleAccept, this, new_session, std::placeholders::_1));
+    acceptor->async_accept(new_session->Socket(), std::bind(&Server::HandleAccept, this, new_session, std::placeholders::_1));
 }
 
 void Server::HandleAccept(shared_ptr<Session> new_session, const boost::system::error_code& error){
-    if(!error){
-        new_session->Start();
-        _sessions.insert(make_pair(new_session->GetUuid(), new_session));
-    }else{
-        //delete new_session;
+    //关闭开始后完成的 accept 直接丢弃；REUSE_PORT 模式下 HandleAccept 在 IO 线程上执行，_stopping 是原子的
+    if(_stopping.load(std::memory_order_relaxed)){
+        return;
+    }
+    //SINGLE 模式只有一个 acceptor，REUSE_PORT 模式下会话所在的 IO 线程就是 acceptor 所在的线程
+    std::size_t index = _io_acceptors.empty() ? 0 : new_session->GetIOIndex();
+    if(error){
+        RetryAccept(index, error);
+        return;
+    }
+    _accept_retries[index]->delay = std::chrono::milliseconds(MIN_ACCEPT_RETRY_MS);
+    //先登记再启动：Start 之后回调可能立即在其他线程上触发 ClearSession
+    if(!_sessions.Insert(new_session)){
+        //会话ID重复时表中已有的是另一个活动会话，不能走 Close（ClearSession 会把它移除），只关闭新连接
+        LOG_WARN("Duplicate session id ", new_session->GetSessionId(), ", dropping the new connection");
+        boost::system::error_code ec;
+        new_session->Socket().close(ec);
+        StartAccept(index);
+        return;
+    }
+    Metrics::Add(Metrics::CONNECTIONS_ACCEPTED);
+    _config.socket_options.ApplyTo(new_session->Socket());
+    _pool.AddLoad(new_session->GetIOIndex());
+    new_session->Start();
+    StartAccept(index);
+}
+
+void Server::RetryAccept(std::size_t index, const boost::system::error_code& error){
+    if(error == boost::asio::error::operation_aborted){
+        return;
+    }
+    //EMFILE / ENFILE / ENOBUFS 等错误在条件解除前会立即重复出现，马上重新挂起 accept 只会空转
+    AcceptRetry& retry = *_accept_retries[index];
+    if(retry.pending++ > 0){
+        return;
+    }
+    LOG_WARN("Accept failed: ", error.message(), ", retrying in ", retry.delay.count(), " ms");
+    retry.timer.expires_after(retry.delay);
+    retry.delay = std::min(retry.delay * 2, std::chrono::milliseconds(MAX_ACCEPT_RETRY_MS));
+    retry.timer.async_wait([this, index, &retry](const boost::system::error_code& error){
+        std::size_t pending = retry.pending;
+        retry.pending = 0;
+        if(error || _stopping.load(std::memory_order_relaxed)){
+            return;
+        }
+        for(std::size_t i = 0; i < pending; ++i){
+            StartAccept(index);
+        }
+    });
+}
+
+void Server::ClearSession(std::uint64_t session_id){
+    //读写错误可能先后触发两次 ClearSession，只有真正移除时才减少负载计数
+    shared_ptr<Session> session = _sessions.Erase(session_id);
+    if(!session){
+        return;
+    }
+    Metrics::Add(Metrics::CONNECTIONS_CLOSED);
+    _pool.SubLoad(session->GetIOIndex());
+    if(_stopping.load(std::memory_order_relaxed) && _sessions.Size() == 0){
+        boost::asio::post(_ioc, [this](){
+            FinishShutdown();
+        });
     }
-    StartAccept();
-}   
+}
+
+void Server::Shutdown(std::function<void()> on_done){
+    if(_stopping.exchange(true)){
+        return;
+    }
+    _on_shutdown = std::move(on_done);
+    boost::system::error_code ec;
+    _acceptor.close(ec);
+    //各 IO 线程的 acceptor 和重试定时器只能在所属线程上关闭
+    for(std::size_t index = 0; index < _io_acceptors.size(); ++index){
+        boost::asio::post(_pool.GetIOService(index), [acceptor = _io_acceptors[index].get(), retry = _accept_retries[index].get()](){
+            boost::system::error_code ec;
+            acceptor->close(ec);
+            retry->timer.cancel();
+        });
+    }
+    if(_io_acceptors.empty() && !_accept_retries.empty()){
+        _accept_retries[0]->timer.cancel();
+    }
+    if(_admin){
+        _admin->Stop();
+    }
+    LOG_INFO("Shutting down, draining ", _sessions.Size(), " sessions");
+
+    //1. 每个 IO 线程上的会话停止处理新请求（可选发送告别帧），之后不会再有消息投递给逻辑线程
+    //2. 最后一个 IO 线程完成后，在逻辑线程上排一个任务：它执行时，之前收到的请求都已处理、回复都已入队
+    //3. 各会话写完发送队列后半关闭连接，等对端关闭后移除
+    auto groups = GroupSessions(nullptr);
+    auto remaining = make_shared<std::atomic<std::size_t>>(groups.size());
+    for(std::size_t index = 0; index < groups.size(); ++index){
+        boost::asio::post(_pool.GetIOService(index), [this, remaining, group = std::move(groups[index])](){
+            for(auto& session : group){
+                session->BeginDrain();
+            }
+            if(remaining->fetch_sub(1) != 1){
+                return;
+            }
+            LogicSystem::GetInstance().PostTask([this](){
+                auto groups = GroupSessions(nullptr);
+                for(std::size_t index = 0; index < groups.size(); ++index){
+                    boost::asio::post(_pool.GetIOService(index), [group = std::move(groups[index])](){
+                        for(auto& session : group){
+                            session->FinishDrain();
+                        }
+                    });
+                }
+            });
+        });
+    }
+
+    //超过期限仍未关闭的连接直接关闭
+    _shutdown_timer.expires_after(_config.shutdown_timeout);
+    _shutdown_timer.async_wait([this](const boost::system::error_code& error){
+        if(error){
+            return;
+        }
+        LOG_WARN("Shutdown timeout, closing ", _sessions.Size(), " remaining sessions");
+        auto groups = GroupSessions(nullptr);
+        for(std::size_t index = 0; index < groups.size(); ++index){
+            boost::asio::post(_pool.GetIOService(index), [group = std::move(groups[index])](){
+                for(auto& session : group){
+                    session->Close();
+                }
+            });
+        }
+    });
+    FinishShutdown();
+}
+
+void Server::FinishShutdown(){
+    if(!_on_shutdown || _sessions.Size() != 0){
+        return;
+    }
+    _shutdown_timer.cancel();
+    LOG_INFO("All sessions closed");
+    auto on_done = std::move(_on_shutdown);
+    _on_shutdown = nullptr;
+    on_done();
+}
+
+std::size_t Server::Broadcast(const char* msg, int length, short msg_id){
+    return BroadcastIf(msg, length, msg_id, nullptr);
+}
+
+std::size_t Server::BroadcastIf(const char* msg, int length, short msg_id, const std::function<bool(const Session&)>& filter){
+    //按会话所在的 IO 线程分组，每组投递到对应的 io_context 上入队，
+    //入队和启动写操作的开销分摊到各个 IO 线程，并且 Send 中的 dispatch 会直接执行
+    vector<vector<shared_ptr<Session>>> groups = GroupSessions(filter);
+
+    //帧只编码一次，之后只复制 shared_ptr；协商了压缩的会话按算法共享压缩后的帧，每种算法只压缩一次
+    std::array<shared_ptr<MsgNode>, MSG_FLAG_COMPRESSED + 1> msgnodes;
+    msgnodes.fill(MsgNode::Create(msg, length, msg_id));
+    if(static_cast<std::uint32_t>(length) >= _config.compress_threshold){
+        std::uint8_t codecs = 0;
+        for(auto& group : groups){
+            for(auto& session : group){
+                codecs |= session->GetCodec();
+            }
+        }
+        for(std::uint8_t codec : {MSG_FLAG_LZ4, MSG_FLAG_ZLIB}){
+            if(codecs & codec){
+                msgnodes[codec] = MsgNode::CreateCompressed(msg, length, msg_id, codec);
+            }
+        }
+    }
+    std::size_t count = 0;
+    for(std::size_t index = 0; index < groups.size(); ++index){
+        count += groups[index].size();
+        if(groups[index].empty()){
+            continue;
+        }
+        boost::asio::post(_pool.GetIOService(index), [msgnodes, group = std::move(groups[index])](){
+            for(auto& session : group){
+                session->Send(msgnodes[session->GetCodec()]);
+            }
+        });
+    }
+    return count;
+}
+
+vector<vector<shared_ptr<Session>>> Server::GroupSessions(const std::function<bool(const Session&)>& filter){
+    vector<vector<shared_ptr<Session>>> groups(_pool.Size());
+    _sessions.ForEach([&](const shared_ptr<Session>& session){
+        if(filter && !filter(*session)){
+            return;
+        }
+        groups[session->GetIOIndex()].push_back(session);
+    });
+    return groups;
+}
 
-void Server::ClearSession(std::string uuid){
-    _sessions.erase(uuid);
+bool Server::SendTo(std::uint64_t session_id, const char* msg, int length, short msg_id){
+    return _sessions.SendTo(session_id, msg, length, msg_id);
 }
\ No newline at end of file
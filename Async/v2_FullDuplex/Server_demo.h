@@ -1,24 +1,97 @@
 #include "Session_demo.h"
+#include "AsioIOServicePool.h"
+#include "ServerConfig.h"
+#include "SessionRegistry.h"
+#include "../Common/TimingWheel.h"
+#include "../Common/AdminServer.h"
+#include "../Common/IoUring.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <iostream>
-#include <map>
 #include <memory>
-#include <string>
 using namespace std;
 
 class Server{
 public:
     //构造函数，初始化io_context和acceptor，并开始接受连接
-    Server(boost::asio::io_context& ioc, short  port);
-    void ClearSession(std::string uuid);
+    //ioc 只负责 accept（REUSE_PORT 模式下由各 IO 线程自己 accept），新会话从 pool 中挑选 io_context 运行
+    Server(boost::asio::io_context& ioc, AsioIOServicePool& pool, const ServerConfig& config = ServerConfig());
+    void ClearSession(std::uint64_t session_id);
+    //向指定会话发送消息，可在任意线程调用；会话不存在时返回 false
+    bool SendTo(std::uint64_t session_id, const char* msg, int length, short msg_id);
+    //向所有会话广播一条消息，可在任意线程调用，返回目标会话数
+    //消息只编码一次，所有会话的发送队列共享同一个 MsgNode，内存占用与目标数量无关
+    std::size_t Broadcast(const char* msg, int length, short msg_id);
+    //只向 filter 返回 true 的会话广播；filter 在调用线程上执行
+    std::size_t BroadcastIf(const char* msg, int length, short msg_id, const std::function<bool(const Session&)>& filter);
+    //当前会话表，可在任意线程查找和遍历
+    SessionRegistry& GetSessions(){
+        return _sessions;
+    }
+    //监听器配置，会话据此限制帧长度等
+    const ServerConfig& GetConfig() const{
+        return _config;
+    }
+    //优雅关闭：停止接受连接，每个会话停止处理新请求、写完已有的回复后关闭，
+    //全部关闭（或超过 shutdown_timeout）后在 ioc 线程上调用 on_done。只能在 ioc 线程上调用
+    void Shutdown(std::function<void()> on_done);
+    //第 index 个 IO 线程的时间轮，只能在该线程上使用
+    TimingWheel& GetTimingWheel(std::size_t index){
+        return *_wheels[index];
+    }
+    //第 index 个 IO 线程的 io_uring，使用 ASIO 后端时返回 nullptr；只能在该线程上使用
+    IoUring* GetIoUring(std::size_t index){
+        return _urings.empty() ? nullptr : _urings[index].get();
+    }
 private:
-    //开始接受连接
-    void StartAccept();
+    //开始接受连接；REUSE_PORT 模式下在第 index 个 IO 线程的 acceptor 上接受，SINGLE 模式忽略 index
+    void StartAccept(std::size_t index = 0);
+    //REUSE_PORT 模式：为每个 IO 线程创建一个绑定同一端口的 acceptor，失败时返回 false
+    bool OpenReusePortAcceptors();
     //处理接受连接的回调函数
     void HandleAccept(shared_ptr<Session> new_session, const boost::system::error_code& error);
+    //accept 出错后经 _accept_retries[index] 的定时器延迟重新挂起，连续出错时等待时间翻倍
+    void RetryAccept(std::size_t index, const boost::system::error_code& error);
+    //按所在 IO 线程给会话分组，filter 为空时选取全部会话
+    std::vector<std::vector<shared_ptr<Session>>> GroupSessions(const std::function<bool(const Session&)>& filter);
+    //所有会话都已移除时结束关闭流程，只在 ioc 线程上调用
+    void FinishShutdown();
     //存储活动会话的映射区别是
     boost::asio::io_context& _ioc;
-    //acceptor用于监听传入连接
+    //acceptor用于监听传入连接（SINGLE 模式）
     tcp::acceptor _acceptor;
+    //REUSE_PORT 模式下每个 IO 线程一个 acceptor，只在所属线程上访问
+    std::vector<std::unique_ptr<tcp::acceptor>> _io_acceptors;
+    //重试等待的初始值和上限
+    enum{MIN_ACCEPT_RETRY_MS = 100, MAX_ACCEPT_RETRY_MS = 5000};
+    //accept 出错（如 EMFILE）后的重试状态，每个 acceptor 一份，只在 acceptor 所在线程上访问
+    struct AcceptRetry{
+        explicit AcceptRetry(boost::asio::io_context& ioc):timer(ioc){
+        }
+        boost::asio::steady_timer timer;
+        std::chrono::milliseconds delay{MIN_ACCEPT_RETRY_MS};
+        //等待重新挂起的 accept 数：同时挂起多个 accept 时会先后出错，共用一次等待
+        std::size_t pending = 0;
+    };
+    std::vector<std::unique_ptr<AcceptRetry>> _accept_retries;
+    //会话所在的 IO 线程池
+    AsioIOServicePool& _pool;
+    //监听器配置
+    ServerConfig _config;
 
-    std::map<std::string, shared_ptr<Session>> _sessions;
+    //活动会话表，按会话ID分片加锁，各个 IO 线程上的建连/断连互不阻塞
+    SessionRegistry _sessions;
+    //每个 IO 线程一个时间轮，驱动该线程上所有会话的空闲/写超时和心跳
+    std::vector<std::unique_ptr<TimingWheel>> _wheels;
+    //IO_URING 后端时每个 IO 线程一个 io_uring
+    std::vector<std::unique_ptr<IoUring>> _urings;
+    //本地管理端口，与 acceptor 运行在同一个 io_context 上
+    std::unique_ptr<AdminServer> _admin;
+
+    //是否已开始关闭；ClearSession 在 IO 线程上读取
+    std::atomic<bool> _stopping{false};
+    //以下只在 ioc 线程上访问
+    boost::asio::steady_timer _shutdown_timer;
+    std::function<void()> _on_shutdown;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "SessionRegistry.h"
+#include "Session_demo.h"
+#include <vector>
+using namespace std;
+
+static_assert((1ull << (64 - 58)) == 64, "shard hash shift must match SHARD_COUNT");
+
+bool SessionRegistry::Insert(const shared_ptr<Session>& session){
+    Shard& shard = GetShard(session->GetSessionId());
+    {
+        lock_guard<mutex> lock(shard.lock);
+        if(!shard.sessions.emplace(session->GetSessionId(), session).second){
+            return false;
+        }
+    }
+    _size.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+shared_ptr<Session> SessionRegistry::Erase(uint64_t session_id){
+    Shard& shard = GetShard(session_id);
+    shared_ptr<Session> session;
+    {
+        lock_guard<mutex> lock(shard.lock);
+        auto iter = shard.sessions.find(session_id);
+        if(iter == shard.sessions.end()){
+            return nullptr;
+        }
+        session = std::move(iter->second);
+        shard.sessions.erase(iter);
+    }
+    _size.fetch_sub(1, memory_order_relaxed);
+    // 会话在锁外析构
+    return session;
+}
+
+shared_ptr<Session> SessionRegistry::Find(uint64_t session_id) const{
+    Shard& shard = GetShard(session_id);
+    lock_guard<mutex> lock(shard.lock);
+    auto iter = shard.sessions.find(session_id);
+    return iter == shard.sessions.end() ? nullptr : iter->second;
+}
+
+bool SessionRegistry::SendTo(uint64_t session_id, const char* msg, int length, short msg_id) const{
+    shared_ptr<Session> session = Find(session_id);
+    if(!session){
+        return false;
+    }
+    // Send 本身是无锁的，在分片锁之外调用
+    session->Send(msg, length, msg_id);
+    return true;
+}
+
+void SessionRegistry::ForEach(const function<void(const shared_ptr<Session>&)>& func) const{
+    vector<shared_ptr<Session>> snapshot;
+    for(Shard& shard : _shards){
+        {
+            lock_guard<mutex> lock(shard.lock);
+            snapshot.reserve(shard.sessions.size());
+            for(auto& item : shard.sessions){
+                snapshot.push_back(item.second);
+            }
+        }
+        for(auto& session : snapshot){
+            func(session);
+        }
+        snapshot.clear();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class Session;
+
+// SessionRegistry: 按会话ID分片的会话表
+// 设计原理：
+// 1. 以 64 位整数会话ID为键，按哈希分到 SHARD_COUNT 个分片，每个分片一把锁 + 一个 unordered_map。
+//    不同 IO 线程上的建连/断连大多落在不同分片，不再争用同一把全局锁，也没有字符串比较。
+// 2. 所有接口都可在任意线程调用。
+// 3. 遍历时逐个分片拷贝出 shared_ptr 后再调用回调，持锁时间只有一次拷贝，不会阻塞 accept。
+class SessionRegistry{
+public:
+    SessionRegistry() = default;
+    SessionRegistry(const SessionRegistry&) = delete;
+    SessionRegistry& operator=(const SessionRegistry&) = delete;
+
+    // 登记会话，ID 已存在时返回 false
+    bool Insert(const std::shared_ptr<Session>& session);
+    // 移除会话并返回它，不存在时返回空指针
+    std::shared_ptr<Session> Erase(std::uint64_t session_id);
+    // 查找会话，不存在时返回空指针
+    std::shared_ptr<Session> Find(std::uint64_t session_id) const;
+    // 向指定会话发送一条消息，会话不存在时返回 false
+    bool SendTo(std::uint64_t session_id, const char* msg, int length, short msg_id) const;
+    // 遍历所有会话；遍历期间新增/移除的会话可能被看到也可能看不到
+    void ForEach(const std::function<void(const std::shared_ptr<Session>&)>& func) const;
+    // 当前会话数
+    std::size_t Size() const{
+        return _size.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum{SHARD_COUNT = 64}; // 必须是 2 的幂
+
+    // 每个分片独占缓存行，避免相邻分片的锁互相伪共享
+    struct alignas(64) Shard{
+        mutable std::mutex lock;
+        std::unordered_map<std::uint64_t, std::shared_ptr<Session>> sessions;
+    };
+
+    Shard& GetShard(std::uint64_t session_id) const{
+        // 乘法哈希：连续分配的 ID 也能均匀打散到各个分片
+        return _shards[(session_id * 0x9E3779B97F4A7C15ull) >> 58];
+    }
+
+    mutable Shard _shards[SHARD_COUNT];
+    std::atomic<std::size_t> _size{0};
+};
@@ -1,40 +1,337 @@
 #include "Session_demo.h"
 #include "Server_demo.h"
-#include <iostream>
+#include "../Common/Logger.h"
 #include <iomanip>
 
 
 using namespace std;
 
-#define HEAD_LENGTH 2
-#define MAX_LENGTH 1024*2
+Session::Session(boost::asio::io_context& ioc, Server* server, std::uint64_t session_id, std::size_t io_index)
+    :_socket(ioc), _executor(ioc.get_executor()), _server(server), _session_id(session_id), _io_index(io_index)
+    ,_wheel(&server->GetTimingWheel(io_index)){
+#ifdef ASYNC_HAS_IO_URING
+    _uring = server->GetIoUring(io_index);
+    _uring_read.session = _uring_write.session = this;
+    _uring_read.handler = &Session::HandleUringRead;
+    _uring_write.handler = &Session::HandleUringWrite;
+#endif
+}
 
 void Session::Start(){
-    _recv_head_node = make_shared<MsgNode>(HEAD_LENGTH);
-    memset(_recv_buffer, 0, MAX_LENGTH);
-    _socket.async_read_some(boost::asio::buffer(_recv_buffer, MAX_LENGTH),
-        std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, shared_from_this()));
+    _recv_buffer.resize(RECV_BUFFER_SIZE);
+    _send_batch.reserve(MAX_SEND_IOVECS);
+    //Start 在 accept 线程上调用，时间轮只能在会话所属的 IO 线程上访问
+    auto self = shared_from_this();
+    boost::asio::dispatch(_socket.get_executor(), [self](){
+        self->_last_read_tick = self->_last_send_tick = self->_wheel->Now();
+        self->_timer.callback = [session = self.get()](){
+            session->OnTimer();
+        };
+        self->ArmTimer();
+        self->StartRead(self);
+    });
+}
+
+void Session::Close(){
+    //定时器持有的引用可能是最后一个，留到函数结束再释放
+    _closed = true;
+    _wheel->Cancel(_timer);
+    shared_ptr<Session> self = std::move(_timer_self);
+    //关闭 socket 后挂起的读写以错误返回，它们再次调用 Close 时 ClearSession 不会重复移除
+    boost::system::error_code ec;
+#ifdef ASYNC_HAS_IO_URING
+    if(_uring != nullptr){
+        //close 不会取消 io_uring 中在途的 recv / sendmsg，先 shutdown 让它们立即返回。
+        //已填写但尚未提交的条目只记录了 fd 号：fd 要等所有操作完成后才能关闭，否则被新连接复用后，
+        //这些读写会落到别的连接上。最后一个操作完成时 HandleUringRead / HandleUringWrite 再次调用 Close 关闭
+        _socket.shutdown(tcp::socket::shutdown_both, ec);
+        if(_uring_read.self || _uring_write.self){
+            _server->ClearSession(_session_id);
+            return;
+        }
+    }
+#endif
+    _socket.close(ec);
+    _server->ClearSession(_session_id);
+}
+
+void Session::BeginDrain(){
+    if(_closed || _draining){
+        return;
+    }
+    _draining = true;
+    if(_server->GetConfig().send_goodbye){
+        Send("", 0, MSG_GOODBYE);
+    }
+}
+
+void Session::FinishDrain(){
+    if(_closed){
+        return;
+    }
+    _draining = true;
+    _flushing = true;
+    TryShutdownSend();
+}
+
+void Session::TryShutdownSend(){
+    if(!_flushing || _send_shutdown || _writing.load() || !_send_queue.Empty()){
+        return;
+    }
+    //回复都已交给内核，发送 FIN；对端读完后关闭连接，HandleRead 读到 EOF 时再 Close
+    //直接 close 时若接收缓冲区里还有未读数据会发出 RST，对端可能来不及读到最后的回复
+    _send_shutdown = true;
+    boost::system::error_code ec;
+    _socket.shutdown(tcp::socket::shutdown_send, ec);
+    if(_read_paused.load(std::memory_order_relaxed)){
+        _read_paused.store(false, std::memory_order_relaxed);
+        StartRead(shared_from_this());
+    }
+}
+
+void Session::ArmTimer(){
+    if(_closed){
+        return;
+    }
+    const ServerConfig& config = _server->GetConfig();
+    //取各项检测中最早的截止时间；截止时间已过时至少等一个 tick
+    std::uint64_t now = _wheel->Now();
+    std::uint64_t deadline = UINT64_MAX;
+    if(config.idle_timeout.count() > 0 && !_read_paused.load(std::memory_order_relaxed)){
+        deadline = std::min(deadline, _last_read_tick + _wheel->ToTicks(config.idle_timeout));
+    }
+    if(config.write_timeout.count() > 0 && _write_in_flight){
+        deadline = std::min(deadline, _write_start_tick + _wheel->ToTicks(config.write_timeout));
+    }
+    if(config.heartbeat_interval.count() > 0){
+        deadline = std::min(deadline, _last_send_tick + _wheel->ToTicks(config.heartbeat_interval));
+    }
+    if(deadline == UINT64_MAX){
+        return;
+    }
+    _wheel->ArmTicks(_timer, deadline > now ? deadline - now : 1);
+    if(!_timer_self){
+        _timer_self = shared_from_this();
+    }
+}
+
+void Session::OnTimer(){
+    const ServerConfig& config = _server->GetConfig();
+    std::uint64_t now = _wheel->Now();
+    //读取因背压暂停时收不到数据是正常的，这时由写超时负责
+    if(config.idle_timeout.count() > 0 && !_read_paused.load(std::memory_order_relaxed)
+        && now - _last_read_tick >= _wheel->ToTicks(config.idle_timeout)){
+        LOG_INFO("Session ", _session_id, " idle timeout, closing");
+        Metrics::Add(Metrics::IDLE_TIMEOUTS);
+        Close();
+        return;
+    }
+    if(config.write_timeout.count() > 0 && _write_in_flight
+        && now - _write_start_tick >= _wheel->ToTicks(config.write_timeout)){
+        LOG_WARN("Session ", _session_id, " write stalled for ", now - _write_start_tick, " ticks, closing");
+        Metrics::Add(Metrics::WRITE_TIMEOUTS);
+        Close();
+        return;
+    }
+    if(config.heartbeat_interval.count() > 0 && now - _last_send_tick >= _wheel->ToTicks(config.heartbeat_interval)){
+        //Send 会在本线程上直接启动写操作并刷新 _last_send_tick；写操作正忙时也记一次，避免每个 tick 都补发
+        _last_send_tick = now;
+        Send("", 0, MSG_HEARTBEAT);
+    }
+    ArmTimer();
 }
 
-std::string& Session::GetUuid(){
-    return _uuid;
+void Session::StartRead(shared_ptr<Session> _self_shared){
+    //从 _recv_begin 起至少要能放下下一个完整帧，并且本次读取至少有 MIN_READ_SIZE 的空间
+    std::size_t remain = _recv_end - _recv_begin;
+    std::size_t want = std::max(_recv_need, remain + MIN_READ_SIZE);
+    if(_recv_begin + want > _recv_buffer.size()){
+        //尾部空间不足时，把未解析的残留数据搬到缓冲区开头
+        if(_recv_begin > 0){
+            ::memmove(_recv_buffer.data(), _recv_buffer.data() + _recv_begin, remain);
+            _recv_begin = 0;
+            _recv_end = remain;
+        }
+        //仍然放不下（收到了大帧），扩容到能容纳整个帧
+        if(want > _recv_buffer.size()){
+            _recv_buffer.resize(want);
+        }
+    }
+#ifdef ASYNC_HAS_IO_URING
+    if(_uring != nullptr){
+        //socket 已关闭时 native_handle() 为 -1，recv 以 EBADF 完成
+        _uring_read.self = std::move(_self_shared);
+        _uring->Recv(_socket.native_handle(), _recv_buffer.data() + _recv_end, _recv_buffer.size() - _recv_end, &_uring_read);
+        return;
+    }
+#endif
+    _socket.async_read_some(boost::asio::buffer(_recv_buffer.data() + _recv_end, _recv_buffer.size() - _recv_end),
+        BindPool(std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, _self_shared)));
 }
 
-void Session::Send(char* msg, int length){
-    bool pending = false;// 是否有未完成的发送操作
-    std::lock_guard<std::mutex> lock(_send_lock);
-    if(!_send_queue.empty()){
-        pending = true;
+#ifdef ASYNC_HAS_IO_URING
+void Session::HandleUringRead(int result, shared_ptr<Session> _self_shared){
+    //会话已关闭，只等在途操作结束后关闭 fd，收到的数据不再处理
+    if(_closed){
+        Close();
+        return;
     }
+    if(result > 0){
+        HandleRead(boost::system::error_code(), static_cast<size_t>(result), std::move(_self_shared));
+    }else if(result == 0){
+        HandleRead(boost::asio::error::eof, 0, std::move(_self_shared));
+    }else{
+        HandleRead(boost::system::error_code(-result, boost::system::system_category()), 0, std::move(_self_shared));
+    }
+}
 
-    _send_queue.push(std::make_shared<MsgNode>(msg, length));
-    if(pending){
+void Session::HandleUringWrite(int result, shared_ptr<Session> _self_shared){
+    if(_closed){
+        Close();
+        return;
+    }
+    if(result <= 0){
+        //sendmsg 返回 0 说明对端已不可写，按断开处理
+        HandleWrite(result == 0 ? boost::asio::error::broken_pipe
+            : boost::system::error_code(-result, boost::system::system_category()), std::move(_self_shared));
+        return;
+    }
+    //部分写入：跳过已写完的 iovec，继续发送剩余部分（async_write 内部也是这样循环的）
+    std::size_t written = static_cast<std::size_t>(result);
+    std::size_t count = _send_batch.size();
+    while(_send_iov_index < count && written >= _send_iovecs[_send_iov_index].iov_len){
+        written -= _send_iovecs[_send_iov_index].iov_len;
+        ++_send_iov_index;
+    }
+    if(_send_iov_index == count){
+        HandleWrite(boost::system::error_code(), std::move(_self_shared));
         return;
     }
+    iovec& partial = _send_iovecs[_send_iov_index];
+    partial.iov_base = static_cast<char*>(partial.iov_base) + written;
+    partial.iov_len -= written;
+    _send_msg.msg_iov = _send_iovecs.data() + _send_iov_index;
+    _send_msg.msg_iovlen = count - _send_iov_index;
+    _uring_write.self = std::move(_self_shared);
+    _uring->SendMsg(_socket.native_handle(), &_send_msg, &_uring_write);
+}
+#endif
 
-    auto& msgnode = _send_queue.front();
-    boost::asio::async_write(_socket, boost::asio::buffer(msgnode->_msg, msgnode->_total_len), 
-        std::bind(&Session::HandleWrite, this, placeholders::_1, shared_from_this()));
+void Session::Send(const char* msg, int length, short msg_id){
+    //协商了压缩算法时，不小于阈值的消息在调用线程上压缩
+    std::uint8_t codec = _codec.load(std::memory_order_relaxed);
+    if(codec != 0 && static_cast<std::uint32_t>(length) >= _server->GetConfig().compress_threshold){
+        Send(MsgNode::CreateCompressed(msg, length, msg_id, codec));
+        return;
+    }
+    Send(MsgNode::Create(msg, length, msg_id));
+}
+
+void Session::Reply(std::uint32_t request_id, const char* msg, int length, short msg_id){
+    if(request_id == 0){
+        Send(msg, length, msg_id);
+        return;
+    }
+    std::uint8_t codec = _codec.load(std::memory_order_relaxed);
+    if(static_cast<std::uint32_t>(length) < _server->GetConfig().compress_threshold){
+        codec = 0;
+    }
+    Send(MsgNode::CreateReply(request_id, msg, length, msg_id, codec));
+}
+
+void Session::Send(std::shared_ptr<MsgNode> msgnode){
+    // 超过硬上限的慢消费者：丢弃消息或断开连接
+    std::size_t bytes = msgnode->_total_len;
+    if(_queued_bytes.load(std::memory_order_relaxed) + bytes > _server->GetConfig().send_queue_limit
+        && OnSendQueueOverflow()){
+        return;
+    }
+    _queued_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    Metrics::Add(Metrics::SEND_QUEUE_BYTES, bytes);
+    // 任意线程都可以无锁入队
+    _send_queue.Push(std::move(msgnode));
+    // 只有把 _writing 从 false 置为 true 的那个生产者负责启动写操作，
+    // 必须在入队完成之后检查，否则消费者可能在清除标志前看不到这条消息
+    if(_writing.exchange(true)){
+        return;
+    }
+    // 写操作必须在会话所属的 io_context 线程上发起；已在该线程上时 dispatch 会直接执行
+    // 从逻辑线程投递的任务对象从 BufferPool 分配，在 IO 线程上释放后经远程释放栈回到逻辑线程
+    auto self = shared_from_this();
+    boost::asio::dispatch(_executor, BindPool([self](){
+        self->StartWrite(self);
+    }));
+}
+
+bool Session::OnSendQueueOverflow(){
+    if(_server->GetConfig().slow_consumer_policy == SlowConsumerPolicy::DROP){
+        _dropped_messages.fetch_add(1, std::memory_order_relaxed);
+        Metrics::Add(Metrics::DROPPED_MESSAGES);
+        return true;
+    }
+    // DISCONNECT：在 IO 线程上关闭连接，挂起的读写随后以错误返回
+    if(!_overflow_closing.exchange(true)){
+        LOG_WARN("Session ", _session_id, " send queue exceeds limit (", GetQueuedBytes(), " bytes queued), disconnecting");
+        auto self = shared_from_this();
+        boost::asio::dispatch(_socket.get_executor(), [self](){
+            //读取已暂停时没有挂起的读操作，直接在这里移除会话
+            self->Close();
+        });
+    }
+    return true;
+}
+
+void Session::StartWrite(shared_ptr<Session> _self_shared){
+    // 尽可能多地取出排队的消息，组成一个 buffer 序列，一次系统调用 (writev) 发送
+    std::size_t bytes = 0;
+    while(_send_batch.size() < MAX_SEND_IOVECS){
+        std::shared_ptr<MsgNode>* front = _send_queue.Peek();
+        if(front == nullptr){
+            break;
+        }
+        // 至少发送一条，即使它本身超过字节上限
+        if(!_send_batch.empty() && bytes + (*front)->_total_len > MAX_SEND_BYTES){
+            break;
+        }
+        std::shared_ptr<MsgNode> msgnode;
+        _send_queue.Pop(msgnode);
+        _send_buffers[_send_batch.size()] = boost::asio::buffer(msgnode->_msg, msgnode->_total_len);
+        bytes += msgnode->_total_len;
+        _send_batch.push_back(std::move(msgnode));
+    }
+    _send_batch_bytes = bytes;
+
+    if(_send_batch.empty()){
+        // 队列已空，清除写标志。exchange 与生产者的 exchange 同步：
+        // 若生产者在此之前已入队但看到标志为 true 而没有启动写操作，这里一定能看到它的消息
+        _writing.exchange(false);
+        if(_send_queue.Empty() || _writing.exchange(true)){
+            TryShutdownSend();
+            return;
+        }
+        StartWrite(_self_shared);
+        return;
+    }
+
+    _write_in_flight = true;
+    _write_start_tick = _last_send_tick = _wheel->Now();
+    _send_batch_start = Metrics::NowNs();
+#ifdef ASYNC_HAS_IO_URING
+    if(_uring != nullptr){
+        for(std::size_t i = 0; i < _send_batch.size(); ++i){
+            _send_iovecs[i].iov_base = const_cast<void*>(_send_buffers[i].data());
+            _send_iovecs[i].iov_len = _send_buffers[i].size();
+        }
+        _send_iov_index = 0;
+        _send_msg.msg_iov = _send_iovecs.data();
+        _send_msg.msg_iovlen = _send_batch.size();
+        _uring_write.self = std::move(_self_shared);
+        _uring->SendMsg(_socket.native_handle(), &_send_msg, &_uring_write);
+        return;
+    }
+#endif
+    boost::asio::async_write(_socket, std::span<const boost::asio::const_buffer>(_send_buffers.data(), _send_batch.size()),
+        BindPool(std::bind(&Session::HandleWrite, this, placeholders::_1, _self_shared)));
 }
 
 void Session::HandleRead(const boost::system::error_code& error, 
@@ -42,132 +339,177 @@ void Session::HandleRead(const boost::system::error_code& error,
     
     //粘包测试
     // if(!error){
-    //     PrintRecvData(_recv_buffer, bytes_transferred);
+    //     PrintRecvData(_recv_buffer + _recv_end, bytes_transferred);
     //     std::chrono::milliseconds dura(2000);
     //     std::this_thread::sleep_for(dura);
     // }
 
-    if(!error){
-        //已经成功读取数据长度
-        int copy_len = 0;
-        while(bytes_transferred > 0){
-            if (!_b_head_parsed){
-                //收到的消息不足一个头的长度，继续读取
-                if(bytes_transferred + _recv_head_node->_cur_len < HEAD_LENGTH){
-                    memcpy(_recv_head_node->_msg + _recv_head_node->_cur_len, _recv_buffer + copy_len, bytes_transferred);
-                    _recv_head_node->_cur_len += bytes_transferred;
-                    memset(_recv_buffer, 0, MAX_LENGTH);
-                    _socket.async_read_some(boost::asio::buffer(_recv_buffer, MAX_LENGTH),
-                        std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, _self_shared));
-                    return;
-                }
-
-                //收到的数据足够一个头的长度
-                int head_remain = HEAD_LENGTH - _recv_head_node->_cur_len;
-                memcpy(_recv_head_node->_msg + _recv_head_node->_cur_len, _recv_buffer + copy_len, head_remain);
-                copy_len += head_remain;
-                bytes_transferred -= head_remain;
-                //获取头部数据
-                short data_len = 0;
-                memcpy(&data_len, _recv_head_node->_msg, HEAD_LENGTH);
-                cout << "Parsed message length: " << data_len << endl;
-                
-                if (data_len > MAX_LENGTH){
-                    // 消息长度超过最大限制，关闭会话
-                    cerr << "Message length exceeds maximum limit: " << data_len << endl;
-                    _server->ClearSession(_uuid);
-                    return;
-                }
-
-                _recv_msg_node = make_shared<MsgNode>(data_len);
-                if (bytes_transferred < data_len){
-                    //剩余数据不足一个消息体，继续读取
-                    memcpy(_recv_msg_node->_msg + _recv_msg_node->_cur_len, _recv_buffer + copy_len, bytes_transferred);
-                    _recv_msg_node->_cur_len += bytes_transferred;
-
-                    memset(_recv_buffer, 0, MAX_LENGTH);
-                    _socket.async_read_some(boost::asio::buffer(_recv_buffer, MAX_LENGTH),
-                        std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, _self_shared));
-                    
-                    //头部处理完成
-                    _b_head_parsed = true;
-                    return;
-                }
-
-                memcpy(_recv_msg_node->_msg + _recv_msg_node->_cur_len, _recv_buffer + copy_len, data_len);
-                _recv_msg_node->_cur_len += data_len;
-                copy_len += data_len;
-                bytes_transferred -= data_len;
-                _recv_msg_node->_msg[_recv_msg_node->_cur_len] = '\0';
-                //头部处理完成
-                cout << "Received from client: " << _socket.remote_endpoint().address().to_string() << endl;
-                cout << "Received data: " << _recv_msg_node->_msg << endl;
-                Send(_recv_msg_node->_msg, _recv_msg_node->_cur_len);
-                //继续轮询剩余数据
-                _b_head_parsed = false;
-                _recv_head_node->Clear();
-
-                if(bytes_transferred <= 0){
-                    ::memset(_recv_buffer, 0, MAX_LENGTH);
-                    _socket.async_read_some(boost::asio::buffer(_recv_buffer, MAX_LENGTH),
-                        std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, _self_shared));
-                    return;
-                }
-                continue;
-            }
-            
-            //已经处理完头部，处理上次未接受完的消息数据
-            //接收的数据仍不足剩余未处理的
-            int remain_msg = _recv_msg_node->_total_len - HEAD_LENGTH - _recv_msg_node->_cur_len;
-            if (bytes_transferred < remain_msg) {
-                memcpy(_recv_msg_node->_msg + _recv_msg_node->_cur_len, _recv_buffer + copy_len, bytes_transferred);
-                _recv_msg_node->_cur_len += bytes_transferred;
-                ::memset(_recv_buffer, 0, MAX_LENGTH);
-                _socket.async_read_some(boost::asio::buffer(_recv_buffer, MAX_LENGTH), 
-                    std::bind(&Session::HandleRead, this, placeholders::_1, placeholders::_2, _self_shared));
-                return;
-            }
-            //接收的数据足够剩余未处理的
-            memcpy(_recv_msg_node->_msg + _recv_msg_node->_cur_len, _recv_buffer + copy_len, remain_msg);
-            _recv_msg_node->_cur_len += remain_msg;
-            bytes_transferred -= remain_msg;
-            copy_len += remain_msg;
-            _recv_msg_node->_msg[_recv_msg_node->_cur_len] = '\0';
-            cout << "receive data is " << _recv_msg_node->_msg << endl;
-            //此处可以调用Send发送测试
-            Send(_recv_msg_node->_msg, _recv_msg_node->_cur_len);
-            //继续轮询剩余未处理数据
-            _b_head_parsed = false;
-            _recv_head_node->Clear();
-            if (bytes_transferred <= 0) {
-                ::memset(_recv_buffer, 0, MAX_LENGTH);
-                _socket.async_read_some(boost::asio::buffer(_recv_buffer, MAX_LENGTH),
-                    std::bind(&Session::HandleRead, this, std::placeholders::_1, std::placeholders::_2, _self_shared));
-                return;
-            }
-            continue;
-        }
-    }else {
-        std::cout << "handle read failed, error is " << error.what() << endl;
-        _server->ClearSession(_uuid);
+    if(error){
+        LOG_INFO("handle read failed, error is ", error.message());
+        Close();
+        return;
     }
+
+    //记录活动时间只是一次赋值，空闲检测在定时器到期时进行
+    _last_read_tick = _wheel->Now();
+    Metrics::Add(Metrics::BYTES_IN, bytes_transferred);
+    if(_draining){
+        //关闭过程中不再处理新请求，数据直接丢弃；继续读取以便及时发现对端关闭
+        _recv_begin = 0;
+        _recv_end = 0;
+        _recv_need = MSG_HEAD_LENGTH;
+        StartRead(_self_shared);
+        return;
+    }
+    _recv_end += bytes_transferred;
+    _recv_need = MSG_HEAD_LENGTH;
+    const std::uint32_t max_frame_size = _server->GetConfig().max_frame_size;
+    std::uint64_t frames = 0;
+    //在接收缓冲区中原地解析所有完整的帧，不再拷贝到 MsgNode
+    while(_recv_end - _recv_begin >= MSG_HEAD_LENGTH){
+        //获取头部数据
+        MsgHeader head = DecodeMsgHeader(_recv_buffer.data() + _recv_begin);
+        if(head.version != MSG_HEAD_VERSION || head.length > max_frame_size){
+            // 协议版本不符或消息长度超过最大限制，关闭会话；之前已解析出的消息仍然交给逻辑线程
+            LOG_WARN("Invalid message header, version: ", head.version, ", length: ", head.length,
+                ", max frame size: ", max_frame_size);
+            Metrics::Add(Metrics::PARSE_ERRORS);
+            Metrics::Add(Metrics::FRAMES_IN, frames);
+            LogicSystem::GetInstance().PostMsgToQue(_logic_batch);
+            Close();
+            return;
+        }
+
+        //剩余数据不足一个完整的帧，记下需要的长度，等待后续数据
+        std::size_t frame_len = MSG_HEAD_LENGTH + static_cast<std::size_t>(head.length);
+        if(_recv_end - _recv_begin < frame_len){
+            _recv_need = frame_len;
+            break;
+        }
+
+        //心跳只用于刷新活动时间，协商消息在 IO 线程上直接处理，都不交给业务逻辑
+        const char* body = _recv_buffer.data() + _recv_begin + MSG_HEAD_LENGTH;
+        if(head.msg_id == MSG_HELLO){
+            HandleHello(body, head.length);
+        }else if(head.msg_id != MSG_HEARTBEAT
+            && !HandleMsg(static_cast<short>(head.msg_id), head.flags, body, static_cast<int>(head.length))){
+            LOG_WARN("Invalid frame body, flags: ", static_cast<int>(head.flags), ", length: ", head.length);
+            Metrics::Add(Metrics::PARSE_ERRORS);
+            Metrics::Add(Metrics::FRAMES_IN, frames);
+            LogicSystem::GetInstance().PostMsgToQue(_logic_batch);
+            Close();
+            return;
+        }
+        _recv_begin += frame_len;
+        ++frames;
+    }
+    Metrics::Add(Metrics::FRAMES_IN, frames);
+
+    //本次读取到的所有完整消息一次性交给逻辑线程
+    LogicSystem::GetInstance().PostMsgToQue(_logic_batch);
+
+    //缓冲区已全部解析完，直接回到开头，避免搬移
+    if(_recv_begin == _recv_end){
+        _recv_begin = 0;
+        _recv_end = 0;
+    }
+    //对端读得比发得慢：发送队列超过高水位时暂停读取，由 HandleWrite 在回落到低水位后恢复
+    if(_queued_bytes.load(std::memory_order_relaxed) > _server->GetConfig().send_high_water){
+        LOG_DEBUG("Session ", _session_id, " read paused, ", GetQueuedBytes(), " bytes queued");
+        _read_paused.store(true, std::memory_order_relaxed);
+        return;
+    }
+    StartRead(_self_shared);
 }
 
+bool Session::HandleMsg(short msg_id, std::uint8_t flags, const char* data, int length){
+    //请求帧：消息体开头是请求ID，剥掉后按普通消息处理，处理函数通过 MsgContext 拿到请求ID回复
+    std::uint32_t request_id = 0;
+    if(flags & MSG_FLAG_REQUEST){
+        if(length < MSG_REQUEST_ID_LENGTH){
+            return false;
+        }
+        request_id = DecodeRequestId(data);
+        data += MSG_REQUEST_ID_LENGTH;
+        length -= MSG_REQUEST_ID_LENGTH;
+    }
+    //内置消息在 IO 线程上查好静态分发表项，定长消息在拷贝之前校验长度，长度不符的消息丢弃
+    const SessionRoute* route = LogicSystem::FindRoute(msg_id);
+    shared_ptr<MsgNode> recv_node;
+    std::uint8_t codec = flags & MSG_FLAG_COMPRESSED;
+    if(codec != 0){
+        //压缩帧：原始长度同样受最大帧长度限制，从内存池分配恰好大小的节点，直接解压到节点中
+        std::uint32_t original = 0;
+        if(!Compression::OriginalLength(data, length, original) || original > _server->GetConfig().max_frame_size){
+            return false;
+        }
+        if(!CheckRouteLength(route, msg_id, static_cast<int>(original))){
+            return true;
+        }
+        recv_node = MsgNode::Create(static_cast<int>(original));
+        if(!Compression::Decompress(codec, data, length, recv_node->_msg, original)){
+            return false;
+        }
+        recv_node->_cur_len = static_cast<int>(original);
+    }else{
+        if(!CheckRouteLength(route, msg_id, length)){
+            return true;
+        }
+        //接收缓冲区会被后续读取覆盖，投递到逻辑线程前需要拷贝一份
+        recv_node = MsgNode::Create(length);
+        memcpy(recv_node->_msg, data, length);
+        recv_node->_cur_len = length;
+    }
+    _logic_batch.push_back(std::allocate_shared<LogicNode>(PoolAllocator<LogicNode>(),
+        MsgContext{shared_from_this(), request_id}, msg_id, std::move(recv_node), route));
+    return true;
+}
+
+bool Session::CheckRouteLength(const SessionRoute* route, short msg_id, int length){
+    if(route == nullptr || route->wire_size < 0 || route->wire_size == length){
+        return true;
+    }
+    LOG_WARN("Session ", _session_id, " msg id [", msg_id, "] bad length ", length, ", expected ", route->wire_size);
+    Metrics::Add(Metrics::BAD_LENGTH_MESSAGES);
+    return false;
+}
+
+void Session::HandleHello(const char* data, std::uint32_t length){
+    std::uint8_t remote = length > 0 ? static_cast<std::uint8_t>(data[0]) : 0;
+    std::uint8_t codec = _server->GetConfig().compression ? Compression::Negotiate(Compression::SupportedCodecs(), remote) : 0;
+    //回复本身不压缩；客户端收到回复后才开始发送压缩帧，服务器从现在起压缩回复
+    char reply = static_cast<char>(codec);
+    Send(&reply, 1, MSG_HELLO);
+    _codec.store(codec, std::memory_order_relaxed);
+    LOG_DEBUG("Session ", _session_id, " negotiated codec ", static_cast<int>(codec));
+}
 
 void Session::HandleWrite(const boost::system::error_code& error, 
     shared_ptr<Session> _self_shared){
     if(!error){
-        std::lock_guard<std::mutex> lock(_send_lock);
-        _send_queue.pop();
-        if(!_send_queue.empty()){
-            auto &msgnode = _send_queue.front();
-            // 继续发送队列中的下一条消息
-            boost::asio::async_write(_socket, boost::asio::buffer(msgnode->_msg, msgnode->_total_len),
-                std::bind(&Session::HandleWrite, this, placeholders::_1, _self_shared));
+        // async_write 保证整个 buffer 序列已全部写完，释放本次发送的所有节点
+        Metrics::Record(Metrics::WRITE_LATENCY, Metrics::NowNs() - _send_batch_start);
+        Metrics::Add(Metrics::BYTES_OUT, _send_batch_bytes);
+        Metrics::Add(Metrics::FRAMES_OUT, _send_batch.size());
+        Metrics::Sub(Metrics::SEND_QUEUE_BYTES, _send_batch_bytes);
+        _send_batch.clear();
+        _write_in_flight = false;
+        std::size_t queued = _queued_bytes.fetch_sub(_send_batch_bytes, std::memory_order_relaxed) - _send_batch_bytes;
+        if(_read_paused.load(std::memory_order_relaxed) && queued <= _server->GetConfig().send_low_water
+            && !_overflow_closing.load(std::memory_order_relaxed) && !_send_shutdown){
+            LOG_DEBUG("Session ", _session_id, " read resumed, ", queued, " bytes queued");
+            _read_paused.store(false, std::memory_order_relaxed);
+            //暂停期间不做空闲检测，恢复时重新计时
+            _last_read_tick = _wheel->Now();
+            ArmTimer();
+            StartRead(_self_shared);
         }
+        // 继续发送期间累积的消息，队列为空时 StartWrite 会清除写标志
+        StartWrite(_self_shared);
     }else{
-        cerr << "Write error: " << error.message() << endl;
-        _server->ClearSession(_uuid);
+        // 保持 _writing 为 true，会话关闭后不再发起新的写操作
+        LOG_WARN("Write error: ", error.message());
+        Close();
     }
 }
 
@@ -181,7 +523,7 @@ void Session::PrintRecvData(char* data, int length){
         ss >> hexstr;
         result += hexstr;  
     }
-    cout << "Received data in hex: " << result << endl;
+    LOG_DEBUG("Received data in hex: ", result);
 }
 
 
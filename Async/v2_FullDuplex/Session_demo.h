@@ -1,10 +1,23 @@
 #pragma once
 #include <iostream>
 #include <boost/asio.hpp>
-#include <queue>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
 #include "MsgNode.h"
+#include "LogicSystem.h"
+#include "../Common/MpscQueue.h"
+#include "../Common/Logger.h"
+#include "../Common/SessionId.h"
+#include "../Common/TimingWheel.h"
+#include "../Common/Metrics.h"
+#include "../Common/IoUring.h"
+#ifdef ASYNC_HAS_IO_URING
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
 using namespace std;
 using boost::asio::ip::tcp;
@@ -13,13 +26,14 @@ class Server; // 前向声明
 
 class Session:public enable_shared_from_this<Session>{
 public:
-    Session(boost::asio::io_context& ioc, Server* server):_socket(ioc), _server(server){
-        boost::uuids::uuid a_uuid = boost::uuids::random_generator()();
-        _uuid = boost::uuids::to_string(a_uuid);
-    }
+    //session_id: 由 SessionId::Next() 生成的会话ID，用作 SessionRegistry 的键
+    //io_index: 会话所在 io_context 在线程池中的下标
+    Session(boost::asio::io_context& ioc, Server* server, std::uint64_t session_id, std::size_t io_index = 0);
 
     ~Session(){
-        std::cout << "Session destruct delete this" << this << std::endl;
+        //关闭时仍未写完的数据从发送队列仪表中扣除
+        Metrics::Sub(Metrics::SEND_QUEUE_BYTES, _queued_bytes.load(std::memory_order_relaxed));
+        LOG_DEBUG("Session destruct delete this", static_cast<const void*>(this));
     }
 
     //Socket()作用是返回当前会话的socket引用，以便服务器能够接受连接。
@@ -30,38 +44,180 @@ public:
     //Start()方法用于启动会话，开始异步读取数据。
     void Start();
 
-    //GetUuid()方法返回会话的唯一标识符UUID。
-    std::string& GetUuid();
+    //GetUuid()方法返回会话的UUID文本，由会话ID按需格式化，仅用于日志和对外展示
+    std::string GetUuid() const{
+        return SessionId::ToUuid(_session_id);
+    }
+
+    //GetSessionId()返回会话ID
+    std::uint64_t GetSessionId() const{
+        return _session_id;
+    }
+
+    //GetIOIndex()返回会话所在 io_context 的下标
+    std::size_t GetIOIndex() const{
+        return _io_index;
+    }
+
+    //Send()方法用于发送数据到客户端，可在任意线程调用。
+    void Send(const char* msg, int length, short msg_id);
+    //发送一个已编码好的发送节点，可在任意线程调用。
+    //节点入队后不得再修改，同一个节点可以同时排在多个会话的队列中（见 Server::Broadcast）。
+    void Send(std::shared_ptr<MsgNode> msgnode);
+    //发送一条类型化消息（见 MsgSchema.h），直接编码到发送节点，可在任意线程调用。
+    //定长消息都很小，不做压缩。
+    template <TypedMsg Msg>
+    void Send(const Msg& msg){
+        Send(MsgNode::Create(msg));
+    }
+    //回复一个请求（MSG_FLAG_REQUEST）：带上同一请求ID，客户端据此匹配在途的请求，可在任意线程调用。
+    //request_id 为 0（消息不是请求）时等同于 Send。
+    void Reply(std::uint32_t request_id, const char* msg, int length, short msg_id);
+    template <TypedMsg Msg>
+    void Reply(std::uint32_t request_id, const Msg& msg){
+        Send(MsgNode::Create(msg, request_id));
+    }
+
+    //发送队列中尚未写完的字节数，可在任意线程读取
+    std::size_t GetQueuedBytes() const{
+        return _queued_bytes.load(std::memory_order_relaxed);
+    }
+    //因发送队列超过硬上限而丢弃的消息数（DROP 策略）
+    std::uint64_t GetDroppedMessages() const{
+        return _dropped_messages.load(std::memory_order_relaxed);
+    }
+    //协商得到的压缩算法（MSG_FLAG_LZ4 / MSG_FLAG_ZLIB），0 表示不压缩，可在任意线程读取
+    std::uint8_t GetCodec() const{
+        return _codec.load(std::memory_order_relaxed);
+    }
+    //是否因发送队列超过高水位而暂停了读取
+    bool IsReadPaused() const{
+        return _read_paused.load(std::memory_order_relaxed);
+    }
 
-    //Send()方法用于发送数据到客户端。
-    void Send(char* msg, int length);
+    //关闭连接并从服务器移除，只在 io_context 线程上调用，可重复调用
+    void Close();
+    //优雅关闭第一步：不再处理新请求（收到的数据直接丢弃），可选发送告别帧；只在 io_context 线程上调用
+    void BeginDrain();
+    //优雅关闭第二步：发送队列写完后半关闭连接，等对端关闭后移除；只在 io_context 线程上调用
+    void FinishDrain();
+
+    //GetServer()返回会话所属的服务器
+    Server* GetServer() const{
+        return _server;
+    }
 
     //粘包测试
     void PrintRecvData(char* data, int length);
 
 private:
+    //发起一次 async_read_some，必要时先整理接收缓冲区
+    void StartRead(shared_ptr<Session> _self_shared);
     //处理读取数据的回调函数
     void HandleRead(const boost::system::error_code& error, size_t bytes_transferred, shared_ptr<Session> _self_shared);
     //处理写入数据的回调函数
     void HandleWrite(const boost::system::error_code& error, shared_ptr<Session> _self_shared);
+    //将发送队列中的多条消息合并为一次 async_write（writev），只在会话所属的 io_context 线程上调用
+    void StartWrite(shared_ptr<Session> _self_shared);
+    //处理一条完整的消息，data 直接指向接收缓冲区，仅在本次调用期间有效
+    //消息被拷贝（压缩帧则解压）后放入 _logic_batch，一次 HandleRead 结束时整批投递给 LogicSystem
+    //请求帧短于请求ID、压缩帧无法解压或解压后超过最大帧长度时返回 false
+    bool HandleMsg(short msg_id, std::uint8_t flags, const char* data, int length);
+    //定长的内置消息长度不符时打印警告并返回 false，调用方丢弃该消息
+    bool CheckRouteLength(const SessionRoute* route, short msg_id, int length);
+    //处理客户端的 MSG_HELLO：选定压缩算法并回复
+    void HandleHello(const char* data, std::uint32_t length);
+    //发送队列超过硬上限时按策略处理，返回 true 表示消息应被丢弃
+    bool OnSendQueueOverflow();
+    //FinishDrain 之后发送队列已空时半关闭连接（只关闭发送方向）
+    void TryShutdownSend();
+    //按最近的截止时间挂入时间轮；ArmTimer 在未启用任何超时时什么也不做
+    void ArmTimer();
+    //时间轮到期回调：检查空闲/写超时，必要时发送心跳，然后重新挂入
+    void OnTimer();
+#ifdef ASYNC_HAS_IO_URING
+    //IO_URING 后端的读写完成回调，result 为 recv / sendmsg 的返回值
+    void HandleUringRead(int result, shared_ptr<Session> _self_shared);
+    void HandleUringWrite(int result, shared_ptr<Session> _self_shared);
+#endif
     //Socket对象，表示与客户端的连接
     tcp::socket _socket;
-    //用于存储接收数据的缓冲区
-    enum{MAX_LENGTH = 1024};
-    //接收数据缓冲区
-    char _recv_buffer[MAX_LENGTH];
+    //所属 io_context 的具体执行器：dispatch 按处理函数关联的分配器分配任务对象（any_executor 总是用 std::allocator）
+    boost::asio::io_context::executor_type _executor;
+    //接收缓冲区初始大小、每次读取至少预留的空间
+    //最大帧长度由监听器配置（ServerConfig），缓冲区只在收到大帧时按需扩容
+    enum{RECV_BUFFER_SIZE = 16 * 1024, MIN_READ_SIZE = 4 * 1024};
+    //接收数据缓冲区：[_recv_begin, _recv_end) 为已接收但未解析的数据
+    std::vector<char> _recv_buffer;
+    std::size_t _recv_begin = 0;
+    std::size_t _recv_end = 0;
+    //从 _recv_begin 起凑齐下一个完整帧还需要的总字节数（帧头未收全时为帧头长度）
+    std::size_t _recv_need = MSG_HEAD_LENGTH;
+    //本次 HandleRead 解析出的待投递消息，只在 io_context 线程上访问
+    std::vector<shared_ptr<LogicNode>> _logic_batch;
     //指向服务器对象的指针，用于管理会话
     Server* _server;
-    //会话的唯一标识符UUID
-    std::string _uuid;
-    // 发送消息队列和互斥锁
-    std::queue<std::shared_ptr<MsgNode>> _send_queue;
-    std::mutex _send_lock;
-
-    // 接收消息结构
-    std::shared_ptr<MsgNode> _recv_msg_node;
-    bool _b_head_parsed = false; // 是否已解析消息头
-    // 消息头结构
-    std::shared_ptr<MsgNode> _recv_head_node;
+    //会话ID
+    std::uint64_t _session_id;
+    //所在 io_context 的下标
+    std::size_t _io_index;
+    // 无锁发送队列：任意线程入队，会话所属的 io_context 线程出队
+    MpscQueue<std::shared_ptr<MsgNode>> _send_queue;
+    // 是否有写操作在进行（或已投递待执行），保证同一时刻只有一个 async_write
+    std::atomic<bool> _writing{false};
+    // 单次合并写入的上限：iovec 个数和字节数
+    enum{MAX_SEND_IOVECS = 64, MAX_SEND_BYTES = 64 * 1024};
+    // 正在发送的节点及其 buffer 序列，只在 io_context 线程上访问
+    std::vector<std::shared_ptr<MsgNode>> _send_batch;
+    std::array<boost::asio::const_buffer, MAX_SEND_IOVECS> _send_buffers;
+    std::size_t _send_batch_bytes = 0;
+    // 本次合并写的发起时间（纳秒），用于写耗时直方图
+    std::uint64_t _send_batch_start = 0;
+    // 已入队但尚未写完的字节数：生产者入队时增加，HandleWrite 写完后减少
+    std::atomic<std::size_t> _queued_bytes{0};
+    std::atomic<std::uint64_t> _dropped_messages{0};
+    // 协商得到的压缩算法，只在 io_context 线程上修改
+    std::atomic<std::uint8_t> _codec{0};
+    // 读取是否因高水位暂停，只在 io_context 线程上修改
+    std::atomic<bool> _read_paused{false};
+    // 是否已因超过硬上限而要求断开，保证只断开一次
+    std::atomic<bool> _overflow_closing{false};
+
+    // 以下只在 io_context 线程上访问
+    // 所在 IO 线程的时间轮
+    TimingWheel* _wheel;
+    // 会话唯一的定时器：到期时统一检查各项超时，读写时只记录时间轮的 tick，不做任何挂入/摘除
+    TimerNode _timer;
+    // 定时器挂着期间持有自身，Close 时释放
+    std::shared_ptr<Session> _timer_self;
+    std::uint64_t _last_read_tick = 0;  // 最近一次收到数据
+    std::uint64_t _last_send_tick = 0;  // 最近一次发起写操作
+    std::uint64_t _write_start_tick = 0; // 当前写操作的开始时间
+    bool _write_in_flight = false;
+    bool _closed = false;
+    // 优雅关闭的状态：已停止处理新请求 / 等待发送队列写完 / 已半关闭
+    bool _draining = false;
+    bool _flushing = false;
+    bool _send_shutdown = false;
+
+#ifdef ASYNC_HAS_IO_URING
+    // 所在 IO 线程的 io_uring，ASIO 后端时为 nullptr
+    IoUring* _uring;
+    // 在途的 io_uring 操作：嵌入会话中，提交时持有会话，完成时交给回调
+    struct UringOp final:public IoUringOp{
+        Session* session = nullptr;
+        void (Session::*handler)(int, shared_ptr<Session>) = nullptr;
+        shared_ptr<Session> self;
+        void Complete(int result) override{
+            (session->*handler)(result, std::move(self));
+        }
+    };
+    UringOp _uring_read;
+    UringOp _uring_write;
+    // sendmsg 的 iovec 序列；部分写入时从 _send_iov_index 起继续发送
+    std::array<iovec, MAX_SEND_IOVECS> _send_iovecs;
+    std::size_t _send_iov_index = 0;
+    msghdr _send_msg{};
+#endif
 };
 
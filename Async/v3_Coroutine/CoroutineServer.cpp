@@ -0,0 +1,29 @@
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "Server.h"
+
+// 用法: CoroutineServer [IO线程数] [最大帧长度]
+// 参数含义与 v2 的 AsyncServer 相同，帧格式也相同，可以用同一个 LoadGenerator 对比
+int main(int argc, char* argv[]){
+    try{
+        std::size_t io_threads = std::thread::hardware_concurrency();
+        if(argc > 1){
+            io_threads = static_cast<std::size_t>(std::atoi(argv[1]));
+        }
+        ServerConfig config;
+        if(argc > 2){
+            config.max_frame_size = static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10));
+        }
+        AsioIOServicePool pool(io_threads);
+
+        //主 io_context 只运行 accept 协程
+        boost::asio::io_context io_context;
+        Server server(io_context, pool, config);
+        io_context.run();
+    }catch(std::exception& e){
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "Server.h"
+#include "Session.h"
+#include "../Common/Logger.h"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+using namespace std;
+
+Server::Server(boost::asio::io_context& ioc, AsioIOServicePool& pool, const ServerConfig& config):_ioc(ioc)
+    ,_acceptor(ioc, tcp::endpoint(tcp::v4(), config.port)), _pool(pool), _config(config){
+    LOG_INFO("Coroutine server started on port: ", config.port, ", max frame size: ", config.max_frame_size);
+    boost::asio::co_spawn(_ioc, AcceptLoop(), boost::asio::detached);
+}
+
+boost::asio::awaitable<void> Server::AcceptLoop(){
+    for(;;){
+        //从线程池中挑选一个 io_context，新 socket 直接绑定到它上面
+        std::size_t index = _pool.NextIndex();
+        boost::system::error_code error;
+        tcp::socket socket = co_await _acceptor.async_accept(_pool.GetIOService(index),
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        if(error){
+            LOG_WARN("accept failed, error is ", error.message());
+            if(!_acceptor.is_open()){
+                co_return;
+            }
+            continue;
+        }
+        make_shared<Session>(std::move(socket), this, index)->Start();
+    }
+}
+
+void Server::OnSessionStart(Session& session){
+    _pool.AddLoad(session.GetIOIndex());
+}
+
+void Server::OnSessionClose(Session& session){
+    _pool.SubLoad(session.GetIOIndex());
+}
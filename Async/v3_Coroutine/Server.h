@@ -0,0 +1,33 @@
+#pragma once
+#include <utility>
+#include <boost/asio.hpp>
+#include <boost/asio/awaitable.hpp>
+#include "../v2_FullDuplex/AsioIOServicePool.h"
+#include "../v2_FullDuplex/ServerConfig.h"
+
+using boost::asio::ip::tcp;
+
+class Session;
+
+// Server: 协程版监听器
+// accept 循环是一个协程，运行在主 io_context 上；新连接直接 accept 到线程池中挑选的 io_context。
+class Server{
+public:
+    Server(boost::asio::io_context& ioc, AsioIOServicePool& pool, const ServerConfig& config = ServerConfig());
+
+    const ServerConfig& GetConfig() const{
+        return _config;
+    }
+
+    //会话启动/结束时维护线程池的负载计数
+    void OnSessionStart(Session& session);
+    void OnSessionClose(Session& session);
+
+private:
+    boost::asio::awaitable<void> AcceptLoop();
+
+    boost::asio::io_context& _ioc;
+    tcp::acceptor _acceptor;
+    AsioIOServicePool& _pool;
+    ServerConfig _config;
+};
@@ -0,0 +1,189 @@
+#include "Session.h"
+#include "Server.h"
+#include "../Common/BufferPool.h"
+#include "../Common/Logger.h"
+#include "../Common/MsgId.h"
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+using namespace std;
+
+Session::Session(tcp::socket socket, Server* server, std::size_t io_index)
+    :_socket(std::move(socket)), _server(server), _io_index(io_index)
+    ,_write_signal(_socket.get_executor(), boost::asio::steady_timer::time_point::max()){
+    _recv_capacity = RECV_BUFFER_SIZE;
+    _recv_buffer = static_cast<char*>(BufferPool::Allocate(_recv_capacity));
+    _send_batch.reserve(MAX_SEND_IOVECS);
+}
+
+Session::~Session(){
+    BufferPool::Deallocate(_recv_buffer, _recv_capacity);
+    LOG_DEBUG("Session destruct delete this", static_cast<const void*>(this));
+}
+
+void Session::Start(){
+    _server->OnSessionStart(*this);
+    //两个协程各持有一份 shared_ptr，都结束后会话才析构
+    auto self = shared_from_this();
+    boost::asio::co_spawn(_socket.get_executor(), [self](){ return self->ReadLoop(); }, boost::asio::detached);
+    boost::asio::co_spawn(_socket.get_executor(), [self](){ return self->WriteLoop(); }, boost::asio::detached);
+}
+
+void Session::Close(){
+    auto self = shared_from_this();
+    boost::asio::dispatch(_socket.get_executor(), [self](){
+        self->DoClose();
+    });
+}
+
+void Session::DoClose(){
+    if(_closed){
+        return;
+    }
+    _closed = true;
+    boost::system::error_code ec;
+    _socket.close(ec);
+    //唤醒可能挂起的 WriteLoop，让它退出
+    _write_signal.cancel();
+    _server->OnSessionClose(*this);
+}
+
+void Session::Send(const char* msg, int length, short msg_id){
+    // 任意线程都可以无锁入队
+    _send_queue.Push(MsgNode::Create(msg, length, msg_id));
+    // 只有把 _writing 从 false 置为 true 的那个生产者负责唤醒 WriteLoop
+    if(_writing.exchange(true)){
+        return;
+    }
+    // 定时器不是线程安全的，唤醒必须在会话所属的 io_context 线程上进行
+    auto self = shared_from_this();
+    boost::asio::dispatch(_socket.get_executor(), [self](){
+        self->_write_signal.cancel_one();
+    });
+}
+
+void Session::ReserveRecv(std::size_t need){
+    std::size_t remain = _recv_end - _recv_begin;
+    std::size_t want = std::max(need, remain + MIN_READ_SIZE);
+    if(_recv_begin + want <= _recv_capacity){
+        return;
+    }
+    if(want <= _recv_capacity){
+        //尾部空间不足时，把未解析的残留数据搬到缓冲区开头
+        ::memmove(_recv_buffer, _recv_buffer + _recv_begin, remain);
+    }else{
+        //收到了大帧，换一块能容纳整个帧的缓冲区
+        char* buffer = static_cast<char*>(BufferPool::Allocate(want));
+        ::memcpy(buffer, _recv_buffer + _recv_begin, remain);
+        BufferPool::Deallocate(_recv_buffer, _recv_capacity);
+        _recv_buffer = buffer;
+        _recv_capacity = want;
+    }
+    _recv_begin = 0;
+    _recv_end = remain;
+}
+
+boost::asio::awaitable<void> Session::ReadLoop(){
+    const std::uint32_t max_frame_size = _server->GetConfig().max_frame_size;
+    //从 _recv_begin 起凑齐下一个完整帧还需要的总字节数
+    std::size_t need = MSG_HEAD_LENGTH;
+    boost::system::error_code error;
+    for(;;){
+        ReserveRecv(need);
+        std::size_t n = co_await _socket.async_read_some(
+            boost::asio::buffer(_recv_buffer + _recv_end, _recv_capacity - _recv_end),
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        if(error){
+            LOG_INFO("handle read failed, error is ", error.message());
+            break;
+        }
+        _recv_end += n;
+
+        //与 v2 相同：在接收缓冲区中原地解析所有完整的帧
+        need = MSG_HEAD_LENGTH;
+        bool bad_frame = false;
+        while(_recv_end - _recv_begin >= MSG_HEAD_LENGTH){
+            MsgHeader head = DecodeMsgHeader(_recv_buffer + _recv_begin);
+            if(head.version != MSG_HEAD_VERSION || head.length > max_frame_size){
+                LOG_WARN("Invalid message header, version: ", head.version, ", length: ", head.length,
+                    ", max frame size: ", max_frame_size);
+                bad_frame = true;
+                break;
+            }
+            std::size_t frame_len = MSG_HEAD_LENGTH + static_cast<std::size_t>(head.length);
+            if(_recv_end - _recv_begin < frame_len){
+                need = frame_len;
+                break;
+            }
+            HandleMsg(static_cast<short>(head.msg_id), _recv_buffer + _recv_begin + MSG_HEAD_LENGTH, static_cast<int>(head.length));
+            _recv_begin += frame_len;
+        }
+        if(bad_frame){
+            break;
+        }
+        if(_recv_begin == _recv_end){
+            _recv_begin = 0;
+            _recv_end = 0;
+        }
+    }
+    DoClose();
+}
+
+boost::asio::awaitable<void> Session::WriteLoop(){
+    boost::system::error_code error;
+    while(!_closed){
+        // 尽可能多地取出排队的消息，组成一个 buffer 序列，一次系统调用 (writev) 发送
+        std::size_t bytes = 0;
+        while(_send_batch.size() < MAX_SEND_IOVECS){
+            std::shared_ptr<MsgNode>* front = _send_queue.Peek();
+            if(front == nullptr){
+                break;
+            }
+            if(!_send_batch.empty() && bytes + (*front)->_total_len > MAX_SEND_BYTES){
+                break;
+            }
+            std::shared_ptr<MsgNode> msgnode;
+            _send_queue.Pop(msgnode);
+            _send_buffers[_send_batch.size()] = boost::asio::buffer(msgnode->_msg, msgnode->_total_len);
+            bytes += msgnode->_total_len;
+            _send_batch.push_back(std::move(msgnode));
+        }
+
+        if(_send_batch.empty()){
+            // 队列已空，清除标志后再检查一次（与 v2 StartWrite 相同的握手）；
+            // 确实为空时挂起，等待生产者 cancel 唤醒
+            _writing.exchange(false);
+            if(_send_queue.Empty() || _writing.exchange(true)){
+                co_await _write_signal.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            }
+            continue;
+        }
+
+        co_await boost::asio::async_write(_socket,
+            std::span<const boost::asio::const_buffer>(_send_buffers.data(), _send_batch.size()),
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        _send_batch.clear();
+        if(error){
+            LOG_WARN("Write error: ", error.message());
+            DoClose();
+            break;
+        }
+    }
+}
+
+void Session::HandleMsg(short msg_id, const char* data, int length){
+    //协程版直接在 IO 线程上处理消息，不经过逻辑线程
+    switch(msg_id){
+    case MSG_ECHO:
+        LOG_DEBUG("Received data: ", std::string_view(data, length));
+        Send(data, length, msg_id);
+        break;
+    default:
+        LOG_WARN("msg id [", msg_id, "] handler not found");
+        break;
+    }
+}
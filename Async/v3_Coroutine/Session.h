@@ -0,0 +1,78 @@
+#pragma once
+// Boost 1.74 的 awaitable.hpp 使用了 std::exchange 却没有包含 <utility>
+#include <utility>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/awaitable.hpp>
+#include "../v2_FullDuplex/MsgNode.h"
+#include "../Common/MpscQueue.h"
+#include "../Common/MsgHeader.h"
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+class Server; // 前向声明
+
+// Session: 协程版会话
+// 每个会话由两个协程驱动：ReadLoop 负责收包解析，WriteLoop 负责合并发送。
+// 协程帧持有 shared_ptr，会话在两个协程都结束后自动析构，不再需要 std::bind 和每次读写复制 shared_from_this()。
+class Session:public enable_shared_from_this<Session>{
+public:
+    //socket 已由 acceptor 绑定到会话所在的 io_context
+    //io_index: 会话所在 io_context 在线程池中的下标
+    Session(tcp::socket socket, Server* server, std::size_t io_index);
+    ~Session();
+
+    //启动读写协程
+    void Start();
+
+    //关闭会话，可在任意线程调用
+    void Close();
+
+    std::size_t GetIOIndex() const{
+        return _io_index;
+    }
+
+    //Send()方法用于发送数据到客户端，可在任意线程调用。
+    void Send(const char* msg, int length, short msg_id);
+
+private:
+    //收包协程：读取、原地解析、分发，直到连接断开
+    boost::asio::awaitable<void> ReadLoop();
+    //发包协程：队列为空时挂起在 _write_signal 上，被 Send 唤醒后合并发送
+    boost::asio::awaitable<void> WriteLoop();
+    //处理一条完整的消息，data 直接指向接收缓冲区，仅在本次调用期间有效
+    void HandleMsg(short msg_id, const char* data, int length);
+    //保证接收缓冲区从 _recv_begin 起能放下 need 字节，必要时整理或扩容
+    void ReserveRecv(std::size_t need);
+    //只在会话所属的 io_context 线程上调用
+    void DoClose();
+
+    tcp::socket _socket;
+    Server* _server;
+    std::size_t _io_index;
+    bool _closed = false;
+
+    //接收缓冲区初始大小、每次读取至少预留的空间
+    enum{RECV_BUFFER_SIZE = 16 * 1024, MIN_READ_SIZE = 4 * 1024};
+    //接收缓冲区从 BufferPool 分配，[_recv_begin, _recv_end) 为已接收但未解析的数据
+    char* _recv_buffer = nullptr;
+    std::size_t _recv_capacity = 0;
+    std::size_t _recv_begin = 0;
+    std::size_t _recv_end = 0;
+
+    // 无锁发送队列：任意线程入队，WriteLoop 出队
+    MpscQueue<std::shared_ptr<MsgNode>> _send_queue;
+    // WriteLoop 是否处于活动状态（或已被唤醒），为 false 时由入队的生产者负责唤醒
+    std::atomic<bool> _writing{true};
+    // WriteLoop 空闲时挂起在这个永不到期的定时器上，cancel 即唤醒
+    boost::asio::steady_timer _write_signal;
+    // 单次合并写入的上限：iovec 个数和字节数
+    enum{MAX_SEND_IOVECS = 64, MAX_SEND_BYTES = 64 * 1024};
+    std::vector<std::shared_ptr<MsgNode>> _send_batch;
+    std::array<boost::asio::const_buffer, MAX_SEND_IOVECS> _send_buffers;
+};
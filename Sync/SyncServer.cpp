@@ -1,18 +1,55 @@
 #include <iostream>
 #include <boost/asio.hpp>
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <thread> // 确保包含线程头文件
 
 using boost::asio::ip::tcp;
 
 const int MAX_LENGTH = 1024;
+const unsigned short PORT = 10086;
+// accept 出错（如 EMFILE）后的退避时间：从 100ms 开始翻倍，最长 5s，成功一次后复位
+const std::chrono::milliseconds ACCEPT_RETRY_MIN(100);
+const std::chrono::milliseconds ACCEPT_RETRY_MAX(5000);
+// 关闭时先只关闭接收方向，等待工作线程写完回显；超过宽限期再关闭双向，超过期限直接退出进程
+const std::chrono::seconds SHUTDOWN_GRACE(2);
+const std::chrono::seconds SHUTDOWN_DEADLINE(5);
 
 typedef std::shared_ptr<tcp::socket> socket_ptr;
-std::set<std::shared_ptr<std::thread>> thread_set;
 using namespace std;
 
-void session(socket_ptr sock){
+// 一个连接：socket 和处理它的工作线程。线程不再 detach，关闭时由 main 逐个 join
+struct Connection{
+    socket_ptr sock;
+    std::thread thread;
+    std::atomic<bool> done{false}; // 工作线程已结束，可以 join
+};
+
+std::mutex connections_mutex;
+std::list<std::shared_ptr<Connection>> connections;
+std::atomic<bool> stopping{false};
+std::atomic<bool> server_done{false}; // accept 线程已退出，可以 join
+
+// 轮询等待 pred 成立，最多等到 deadline，返回 pred 最终是否成立
+template <typename Pred>
+bool wait_until(std::chrono::steady_clock::time_point deadline, Pred pred){
+    while(!pred()){
+        if(std::chrono::steady_clock::now() >= deadline){
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+void session(std::shared_ptr<Connection> conn){
+    socket_ptr sock = conn->sock;
     try{
         for(;;){
             char data[MAX_LENGTH];
@@ -21,7 +58,7 @@ void session(socket_ptr sock){
             size_t length = sock->read_some(boost::asio::buffer(data, MAX_LENGTH), error);
             if(error == boost::asio::error::eof){
                 std::cout << "Connection closed by peer." << std::endl;
-                break; 
+                break;
             }else if(error){
                 throw boost::system::system_error(error);
             }
@@ -34,37 +71,133 @@ void session(socket_ptr sock){
     }catch(std::exception& e){
         std::cerr << "Session error: " << e.what() << std::endl;
     }
+    conn->done = true;
 }
 
-void server(boost::asio::io_context& io_context, unsigned short port){
-    tcp::acceptor acceptor (io_context, tcp::endpoint(tcp::v4(), port));
+// 回收已结束的工作线程，避免长时间运行后线程对象越积越多
+void reap_finished(){
+    std::lock_guard<std::mutex> lock(connections_mutex);
+    for(auto it = connections.begin(); it != connections.end();){
+        if((*it)->done){
+            (*it)->thread.join();
+            it = connections.erase(it);
+        }else{
+            ++it;
+        }
+    }
+}
+
+void server(boost::asio::io_context& io_context, tcp::acceptor& acceptor){
+    auto retry_delay = ACCEPT_RETRY_MIN;
     for(;;){
         socket_ptr socket(new tcp::socket(io_context));
-        acceptor.accept(*socket);
+        boost::system::error_code error;
+        acceptor.accept(*socket, error);
+        if(stopping){
+            break; // main 为唤醒 accept 发起的连接，或关闭期间到达的连接，直接丢弃
+        }
+        if(error){
+            // 文件描述符耗尽等错误会让 accept 立即再次失败，直接重试会空转占满 CPU，退避后再试
+            std::cerr << "Accept error: " << error.message() << ", retry in " << retry_delay.count() << "ms" << std::endl;
+            reap_finished();
+            wait_until(std::chrono::steady_clock::now() + retry_delay, [](){ return stopping.load(); });
+            retry_delay = std::min(retry_delay * 2, ACCEPT_RETRY_MAX);
+            continue;
+        }
+        retry_delay = ACCEPT_RETRY_MIN;
 
-        auto t = std::make_shared<std::thread>(session, socket);
-        thread_set.insert(t);
-        t->detach(); // 改动1：新增detach，让线程后台运行，不阻塞
+        reap_finished();
+        auto conn = std::make_shared<Connection>();
+        conn->sock = socket;
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        connections.push_back(conn);
+        conn->thread = std::thread(session, conn);
     }
+    server_done = true;
 }
 
 int main(){
     try{
         boost::asio::io_context io_context;
-        // 改动2：把server放到独立线程运行，避免主线程卡死
-        std::thread server_thread(server, std::ref(io_context), 10086);
-        server_thread.detach();
+        tcp::acceptor acceptor(io_context, tcp::endpoint(tcp::v4(), PORT));
+        // 同步 accept 放到独立线程，主线程等待退出信号
+        std::thread server_thread(server, std::ref(io_context), std::ref(acceptor));
+        std::cout << "Listening on port " << PORT << ", press Ctrl+C to stop" << endl;
 
-        std::cout << "Listening on port 10086" << endl; // 新增：提示监听成功
-        getchar(); // 新增：阻塞主线程，让服务端一直运行
+        // 用 signal_set 等待 SIGINT/SIGTERM，代替 getchar()；没有其他异步操作，收到信号后 run() 返回
+        boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
+        signals.async_wait([](const boost::system::error_code& error, int signal_number){
+            if(!error){
+                std::cout << "Received signal " << signal_number << ", shutting down" << std::endl;
+            }
+        });
+        io_context.run();
 
-        for(auto& t : thread_set){
-            if(t->joinable()){
-                t->join();
+        // 整个关闭过程的期限，超过后不再等待卡住的线程
+        auto deadline = std::chrono::steady_clock::now() + SHUTDOWN_DEADLINE;
+
+        // 1. 停止接受连接：阻塞中的 accept 无法从其他线程可靠地取消，置标志后自己连一次把它唤醒
+        stopping = true;
+        {
+            boost::system::error_code ec;
+            tcp::socket waker(io_context);
+            waker.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), PORT), ec);
+            if(ec){
+                // 连不上（如描述符耗尽）时直接让监听 socket 失效：
+                // Linux 上 shutdown 监听 socket 后阻塞中的 accept 返回 EINVAL，Windows 上 closesocket 会让它返回
+                std::cerr << "Wake accept failed: " << ec.message() << std::endl;
+#ifdef _WIN32
+                acceptor.close(ec);
+#else
+                ::shutdown(acceptor.native_handle(), SHUT_RDWR);
+#endif
+            }
+        }
+        bool clean = wait_until(deadline, [](){ return server_done.load(); });
+        if(clean){
+            server_thread.join();
+        }
+
+        // 2. 把连接表整个取出来，之后的操作都不持有锁；accept 线程没退出时，之后加入的连接不再处理
+        std::list<std::shared_ptr<Connection>> closing;
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            closing.swap(connections);
+        }
+
+        // 3. 关闭每个连接的接收方向：阻塞中的 read_some 返回 EOF，正在写的回显仍会写完
+        for(auto& conn : closing){
+            boost::system::error_code ec;
+            conn->sock->shutdown(tcp::socket::shutdown_receive, ec);
+        }
+        auto all_done = [&closing](){
+            return std::all_of(closing.begin(), closing.end(), [](const std::shared_ptr<Connection>& conn){
+                return conn->done.load();
+            });
+        };
+        // 4. 宽限期后仍未退出的线程多半阻塞在 write 上（对端不读），关闭发送方向让 write 出错返回
+        if(!wait_until(std::min(deadline, std::chrono::steady_clock::now() + SHUTDOWN_GRACE), all_done)){
+            for(auto& conn : closing){
+                if(!conn->done){
+                    boost::system::error_code ec;
+                    conn->sock->shutdown(tcp::socket::shutdown_both, ec);
+                }
             }
         }
+        clean = wait_until(deadline, all_done) && clean;
+        if(!clean){
+            // 仍有线程卡住：它们还在使用全局对象，不能正常析构，直接结束进程
+            std::cerr << "Shutdown deadline exceeded, exiting without waiting" << std::endl;
+            std::_Exit(1);
+        }
+
+        // 5. 所有工作线程都已结束，join 不会阻塞
+        for(auto& conn : closing){
+            conn->thread.join();
+        }
+        std::cout << "Server stopped" << std::endl;
     }catch(std::exception& e){
         std::cerr << "Exception: " << e.what() << "\n";
     }
     return 0;
-}
\ No newline at end of file
+}